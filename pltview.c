@@ -9,9 +9,32 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <math.h>
+#include <errno.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define HAVE_IO_URING 1
+#endif
+#endif
+#endif
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
 #include <X11/Xos.h>
 #include <X11/Xatom.h>
 #include <X11/keysym.h>
@@ -27,43 +50,90 @@
 #include <X11/Xaw/Dialog.h>
 #include <X11/Xaw/AsciiText.h>
 
-#define MAX_VARS 128
-#define MAX_BOXES 1024
 #define MAX_PATH 512
 #define MAX_LINE 1024
-#define MAX_TIMESTEPS 1024
 #define MAX_LEVELS 10
+#define MAX_RESIDENT_FIELDS 4  /* Quiver x/y components plus lon_m/lat_m */
 
 /* Data structures */
 typedef struct {
     int lo[3];
     int hi[3];
     char filename[64];
+    long offset;        /* Byte offset of this FAB within its Cell_D file */
 } Box;
 
+/* On-disk real format of a FAB, from its header descriptor */
+typedef struct {
+    int elem_size;      /* Bytes per value: 8 (float64) or 4 (float32) */
+    int swap;           /* Byte order differs from this host */
+} FabFormat;
+
+/* Per-FAB, per-component value ranges from the min/max tables at the end
+ * of a Cell_H file, indexed [box * n_comps + comp] in FabOnDisk order */
+typedef struct {
+    int n_boxes;
+    int n_comps;
+    int n_tables;       /* 0 = none, 1 = minima read, 2 = minima and maxima */
+    double *min;
+    double *max;
+} RangeIndex;
+
+/* Bounding volume hierarchy over a level's boxes, built when its Cell_H is
+ * read, so plane and cell lookups do not walk every box */
+#define BOX_LEAF_SIZE 4
+typedef struct {
+    int lo[3], hi[3];   /* Bounds of every box below this node */
+    int start, count;   /* Leaf: boxes order[start .. start+count-1] */
+    int left, right;    /* Inner node (count == 0): child nodes */
+} BoxNode;
+
+typedef struct {
+    BoxNode *nodes;
+    int n_nodes;
+    int *order;         /* Box indices grouped by leaf */
+} BoxIndex;
+
 /* Per-level data storage for multi-level overlay rendering */
 typedef struct {
     int grid_dims[3];       /* Grid dimensions for this level */
     int level_lo[3];        /* Lower index bounds in level's coordinates */
     int level_hi[3];        /* Upper index bounds in level's coordinates */
-    Box boxes[MAX_BOXES];   /* Box definitions for this level */
+    Box *boxes;             /* Box definitions for this level */
     int n_boxes;            /* Number of boxes at this level */
-    double *data;           /* Variable data for this level */
+    int box_capacity;       /* Allocated length of boxes */
+    RangeIndex ranges;      /* Cell_H min/max tables for this level */
+    BoxIndex box_index;     /* Spatial index over boxes */
+    size_t *box_offset;     /* Element offset of each box's array in data; [n_boxes] is the total */
+    void *data;             /* Packed per-box variable data (double, or float with --float32) */
     int loaded;             /* Flag: 1 if data is loaded, 0 otherwise */
 } LevelData;
 
 typedef struct {
     char plotfile_dir[MAX_PATH];
-    char variables[MAX_VARS][64];
+    char (*variables)[64];  /* n_vars names, sized from the Header */
     int n_vars;
     int ndim;
     double time;
     int grid_dims[3];
     int level_lo[3];    /* Current level's lower index bounds */
     int level_hi[3];    /* Current level's upper index bounds */
-    Box boxes[MAX_BOXES];
+    Box *boxes;         /* Current level's boxes, sized from Cell_H */
     int n_boxes;
-    double *data;  /* Current variable data */
+    int box_capacity;   /* Allocated length of boxes */
+    RangeIndex ranges;  /* Cell_H min/max tables for the current level */
+    BoxIndex box_index; /* Spatial index over the current level's boxes */
+    void *data;    /* Current variable data (double, or float with --float32) */
+    double *plane;      /* Slice mode: the one resident plane of current_var */
+    int plane_valid;    /* plane holds (plane_var, plane_axis, plane_idx) */
+    int plane_var, plane_axis, plane_idx;
+    /* Companion fields for quiver and map overlays, resident for one
+     * timestep (resident_dir) and level */
+    void *resident_data[MAX_RESIDENT_FIELDS];
+    int resident_var[MAX_RESIDENT_FIELDS];
+    int n_resident;
+    char resident_dir[MAX_PATH];
+    int resident_level;
     int current_var;
     int slice_axis;
     int slice_idx;
@@ -134,9 +204,9 @@ typedef struct {
     double custom_bin_width; /* Custom bin width in um (0 = auto/Sturges) */
     /* Per-grid info from particle Header */
     int n_grids;
-    int grid_file_num[MAX_BOXES];
-    int grid_count[MAX_BOXES];
-    long grid_offset[MAX_BOXES];
+    int *grid_file_num;
+    int *grid_count;
+    long *grid_offset;
 } ParticleData;
 
 /* X11 globals */
@@ -145,17 +215,27 @@ Widget toplevel, form, canvas_widget, var_box, info_label;
 Widget axis_box, nav_box, colorbar_widget, layer_label;
 Window canvas, colorbar;
 GC gc, text_gc, colorbar_gc;
-XImage *ximage;
+XImage *ximage;      /* Frame image, rasterized then put to the back buffer */
+int ximage_fast32 = 0;  /* 32-bit pixels in host byte order: store them directly */
+XShmSegmentInfo shm_info;
+int frame_shm = 0;       /* ximage lives in a MIT-SHM segment shared with the server */
+int frame_shm_busy = 0;  /* An XShmPutImage may still be reading it */
+int *frame_col, *frame_row;  /* Screen column/row -> patch cell, for put_cell_image */
 int screen;
 unsigned long *pixel_data;
 int canvas_width = 800;
 int canvas_height = 600;
 Pixmap pixmap, colorbar_pixmap;
+/* The back buffers hold the last composed frame and colorbar; Expose copies
+ * from them instead of rendering again */
+int frame_valid = 0, colorbar_valid = 0;
 XFontStruct *font;
 double current_vmin = 0, current_vmax = 1;
 
-/* Current slice rendering info for mouse interaction */
+/* Current slice rendering info for mouse interaction. render_slice
+ * extracts into this buffer directly, growing it as needed. */
 double *current_slice_data = NULL;
+size_t current_slice_cap = 0;
 int slice_width = 0, slice_height = 0;
 int render_offset_x = 0, render_offset_y = 0;
 int render_width = 0, render_height = 0;
@@ -170,12 +250,272 @@ double custom_vmin = 0.0;
 double custom_vmax = 1.0;
 
 /* Multi-timestep support */
-char *timestep_paths[MAX_TIMESTEPS];  /* Array of plotfile paths */
-int timestep_numbers[MAX_TIMESTEPS];   /* Numerical values for sorting */
-int timestep_levels[MAX_TIMESTEPS];    /* Number of levels at each timestep */
+char **timestep_paths = NULL;          /* Array of plotfile paths */
+int *timestep_numbers = NULL;          /* Numerical values for sorting */
+int *timestep_levels = NULL;           /* Number of levels at each timestep */
 int n_timesteps = 0;                   /* Number of timesteps found */
+int timestep_capacity = 0;             /* Allocated length of the arrays above */
 int current_timestep = 0;              /* Current timestep index */
 int max_levels_all_timesteps = 1;      /* Max levels across all timesteps */
+
+/* Persistent run metadata index (.pltview_index in the run directory). It
+ * holds every timestep's Header summary, and the Cell_H box layout and
+ * range tables of each level once that level has been opened. Layouts are
+ * appended as they are parsed; the file is rewritten when the run changes.
+ * It is trusted while the run directory's mtime is unchanged; otherwise
+ * each entry is revalidated against its Header's mtime. */
+#define RUN_INDEX_FILE ".pltview_index"
+#define RUN_INDEX_MAGIC "PLTVIDX"
+#define RUN_INDEX_VERSION 1
+typedef struct {
+    int n_boxes;        /* -1 until this level's Cell_H has been indexed */
+    Box *boxes;
+    RangeIndex ranges;
+} RunIndexLevel;
+
+typedef struct {
+    char name[64];      /* Plotfile directory name within the run */
+    int number;
+    int n_levels;       /* Level_N directories present */
+    int header_levels;  /* Finest level as written in the Header */
+    int64_t mtime_ns;   /* Header modification time */
+    double time;
+    int ndim;
+    int n_vars;
+    char (*variables)[64];
+    int grid_dims[3];
+    double prob_lo[3];
+    double prob_hi[3];
+    int ref_ratio;
+    RunIndexLevel levels[MAX_LEVELS];
+} RunIndexEntry;
+
+static RunIndexEntry *run_index = NULL;
+static int n_run_index = 0;
+static char run_index_dir[MAX_PATH] = "";
+static pthread_mutex_t run_index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Precomputed slice sidecars (.pltview_slices_<var>_<axis> in the run
+ * directory), written by --build-slice-cache. One sidecar holds every layer
+ * along one axis of one variable on level 0, for every timestep, as float32
+ * planes behind an offset table, so scrubbing costs one pread per step. */
+#define SLICE_CACHE_PREFIX ".pltview_slices_"
+#define SLICE_CACHE_MAGIC "PLTVSLC"
+#define SLICE_CACHE_VERSION 1
+#define MAX_SLICE_CACHES 32
+typedef struct {
+    char name[64];      /* Plotfile directory name within the run */
+    int64_t mtime_ns;   /* Header modification time when the planes were cut */
+    int valid;          /* 0 = not checked yet, 1 = current, -1 = stale */
+} SliceCacheEntry;
+
+typedef struct {
+    int fd;
+    char var[64];
+    int axis;
+    int dims[3];        /* Level 0 grid the planes were cut from */
+    int n_layers;
+    size_t plane_size;  /* Values per plane */
+    int n_entries;
+    SliceCacheEntry *entries;
+    int64_t *offsets;   /* [entry * n_layers + layer]; 0 = not stored */
+} SliceCache;
+
+static SliceCache slice_caches[MAX_SLICE_CACHES];
+static int n_slice_caches = 0;
+static char slice_cache_dir[MAX_PATH] = "";  /* Run whose sidecars are open */
+
+/* Persistent per-layer statistics (.pltview_stats in the run directory, or
+ * in the plotfile itself when it is opened alone). Each record holds the
+ * mean, std and skewness of every layer along one axis for one (plotfile,
+ * level, variable), keyed by the plotfile Header's mtime. Records are
+ * appended as they are computed; a later record replaces an earlier one. */
+#define STATS_CACHE_FILE ".pltview_stats"
+#define STATS_CACHE_MAGIC "PLTVSTA"
+#define STATS_CACHE_VERSION 1
+#define STATS_MOMENTS 3     /* Mean, std, skewness; NaN mean = layer not computed */
+typedef struct {
+    char name[64];      /* Plotfile directory name within the run, "." alone */
+    char var[64];
+    int level;
+    int axis;
+    int n_layers;
+    int64_t mtime_ns;   /* Header modification time */
+    double *moments;    /* [layer * STATS_MOMENTS + moment] */
+} StatsEntry;
+
+static StatsEntry *stats_cache = NULL;
+static int n_stats_cache = 0;
+static int stats_cache_capacity = 0;
+static char stats_cache_path[MAX_PATH] = "";  /* File the entries came from */
+
+/* Background validation of a run's timestep directories. The timeline is
+ * usable once the first plotfile is validated; the rest, and level counts,
+ * arrive through poll_timestep_scan. */
+#define SCAN_THREADS 16
+#define SCAN_PENDING 0
+#define SCAN_VALID   1
+#define SCAN_INVALID 2
+#define TIMESTEP_SCAN_TIMELINE 1   /* Timesteps were dropped */
+#define TIMESTEP_SCAN_LEVELS   2   /* max_levels_all_timesteps grew */
+#define TIMESTEP_SCAN_DONE     4
+typedef struct {
+    char name[64];              /* Directory name within the run */
+    int number;                 /* Timestep number parsed from the name */
+} ScanCandidate;
+typedef struct {
+    int active;
+    int sdm;                    /* Only check for the particle Header */
+    char base_dir[MAX_PATH];
+    char prefix[64];
+    ScanCandidate *candidates;  /* Candidate directories in timestep order */
+    int n;
+    RunIndexEntry *entries;     /* Result per candidate */
+    unsigned char *state;       /* SCAN_PENDING, SCAN_VALID or SCAN_INVALID */
+    int *slot;                  /* Candidate behind each timeline entry */
+    int n_invalid_seen;
+    RunIndexEntry *old;         /* Previous run index, sorted by name */
+    int n_old;
+    int reused;
+    int next;
+    int n_done;
+    pthread_t threads[SCAN_THREADS];
+    int n_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} TimestepScan;
+static TimestepScan timestep_scan;
+
+/* FAB reader backend, selectable with --io stdio|mmap|uring */
+#define IO_BACKEND_STDIO 0
+#define IO_BACKEND_MMAP  1
+#define IO_BACKEND_URING 2
+int io_backend = IO_BACKEND_MMAP;
+
+/* Reads kept in flight by the io_uring backend, set with --io-depth N */
+#define MAX_IO_DEPTH 4096
+int io_depth = 64;
+
+/* Worker threads used to read and scatter boxes, set with --io-threads N */
+#define MAX_IO_THREADS 64
+int io_threads = 1;
+
+/* Slice mode (--slice-mode): read only the displayed plane, load the full
+ * 3D field on demand for Profile, Distrib and line profiles */
+int slice_mode = 0;
+
+/* Out-of-core mode (--out-of-core MB): slice mode whose Z planes, Profile
+ * and Distrib are served from Z chunks of the current variable, read
+ * straight from the FABs with at most MB of chunks resident. Full 3D loads
+ * that would not fit are refused, and overlay levels count against MB. */
+#define MAX_OOC_CHUNKS 64
+#define OOC_NEAR_LAYERS 2   /* Layers either side of the plane in a first chunk */
+typedef struct {
+    char dir[MAX_PATH];
+    int level;
+    int var;
+    int z0;             /* First layer held, relative to the level's lo */
+    int dims[3];        /* nx, ny and the layers held */
+    void *data;         /* Dense (Z, Y, X) of FIELD_ELEM_SIZE */
+    size_t bytes;
+    unsigned long last_used;
+} OocChunk;
+static OocChunk ooc_chunks[MAX_OOC_CHUNKS];
+static int n_ooc_chunks = 0;
+static size_t ooc_bytes = 0;
+static size_t ooc_level_bytes = 0;  /* Overlay levels held under the budget */
+static unsigned long ooc_clock = 0;
+int ooc_mb = 0;
+
+/* X tile: the X planes of the displayed field that share each row's cache
+ * line, gathered in one pass. An X plane alone reads a cache line per
+ * cell; from the tile it is a contiguous copy. */
+#define XTILE_LINE 64    /* Bytes per cache line */
+#define XTILE_BLOCK 8    /* Rows per gather block */
+static struct {
+    char dir[MAX_PATH];
+    int level;
+    int var;
+    const void *data;   /* Field the tile was gathered from */
+    int dims[3];
+    int x0, width;      /* Planes held */
+    void *planes;       /* width X planes of FIELD_ELEM_SIZE, one after another */
+    size_t bytes;       /* Allocated size of planes */
+} xtile;
+
+/* Set while Series sweeps every timestep: full loads bypass the field cache
+ * so the sweep does not evict the fields being viewed */
+int sweep_mode = 0;
+
+/* --float32: keep loaded 3D fields as float, narrowing on read. This halves
+ * the memory of cached, resident and per-level fields; 2D slices and all
+ * statistics stay double. */
+int field_float32 = 0;
+#define FIELD_ELEM_SIZE (field_float32 ? sizeof(float) : sizeof(double))
+
+/* Element idx of a loaded 3D field, whatever its storage type */
+static inline double field_value(const void *data, size_t idx) {
+    return field_float32 ? ((const float *)data)[idx] : ((const double *)data)[idx];
+}
+
+/* Decoded 3D fields cached by (timestep directory, level, variable) with LRU
+ * eviction under a memory ceiling (--cache-mb). Fields in use by the display
+ * or overlay are pinned and never evicted. */
+#define MAX_CACHE_ENTRIES 256
+typedef struct {
+    char dir[MAX_PATH];
+    int level;
+    int var;
+    void *data;
+    size_t bytes;
+    int refs;
+    unsigned long last_used;
+} FieldCacheEntry;
+static FieldCacheEntry field_cache[MAX_CACHE_ENTRIES];
+/* Overlay levels hold packed per-box fields; they are cached under a
+ * separate level key so they never alias the dense field of that level */
+#define PACKED_LEVEL_KEY(level) ((level) + MAX_LEVELS)
+static int n_field_cache = 0;
+static size_t field_cache_bytes = 0;
+static unsigned long field_cache_clock = 0;
+int cache_mb = 2048;
+unsigned long field_cache_hits = 0, field_cache_misses = 0;
+
+/* Background prefetch of the current variable for neighbouring timesteps,
+ * following the direction the user steps (--prefetch N, --prefetch-mb M) */
+#define MAX_PREFETCH_SLOTS 16
+#define PREFETCH_FREE    0
+#define PREFETCH_QUEUED  1
+#define PREFETCH_LOADING 2
+#define PREFETCH_DONE    3
+typedef struct {
+    int state;
+    char dir[MAX_PATH];
+    int level;
+    int var;
+    void *data;     /* Finished field, owned by the slot until adopted */
+    size_t bytes;
+} PrefetchSlot;
+static PrefetchSlot prefetch_slots[MAX_PREFETCH_SLOTS];
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_cond = PTHREAD_COND_INITIALIZER;
+static size_t prefetch_bytes = 0;   /* Reserved by loading and finished slots */
+static int prefetch_started = 0;
+int prefetch_depth = 1;
+int prefetch_mb = 2048;
+int step_direction = 1;             /* +1 forward, -1 backward */
+
+/* Cell_D files mapped for the current timestep (mmap backend). Mappings are
+ * kept until the timestep changes so variable switches skip open/read. */
+#define MAX_MAPPED_FILES 4096
+typedef struct {
+    char path[MAX_PATH];
+    const char *addr;
+    size_t length;
+} MappedFile;
+static MappedFile mapped_files[MAX_MAPPED_FILES];
+static int n_mapped_files = 0;
+static char mapped_timestep_dir[MAX_PATH] = "";
 Widget time_label = NULL;              /* Time step display label */
 
 /* Data structure for histogram expose handler (forward declaration for SDM) */
@@ -206,6 +546,8 @@ Widget sdm_active_text_widget = NULL;
 int sdm_active_field = 0;  /* 0=cutoff, 1=binwidth */
 Widget sdm_dialog_shell = NULL;
 Widget overlay_button = NULL;  /* Overlay toggle button */
+Widget level_box = NULL;       /* Level buttons and overlay toggle */
+int n_level_buttons = 0;
 Widget map_dialog_shell = NULL;
 Widget map_unavailable_shell = NULL;
 int map_color_option = 0;  /* 0=black, 1=red, 2=gray, 3=white */
@@ -231,12 +573,89 @@ static int n_coastlines = 0;
 /* Function prototypes */
 int detect_levels(PlotfileData *pf);
 int detect_levels_for_path(const char *plotfile_dir);
+int reserve_timesteps(int n);
+int reserve_boxes(Box **boxes, int *capacity, int n);
+void free_plotfile_metadata(PlotfileData *pf);
 void show_level_warning(int level);
 int read_header(PlotfileData *pf);
+int parse_header(PlotfileData *pf, int *header_levels);
 int read_cell_h(PlotfileData *pf);
+int parse_cell_h(const char *path, int ndim, Box **boxes, int *capacity, int *n_boxes,
+                 RangeIndex *ri);
+void box_bounds(const Box *boxes, int n_boxes, int ndim, int *lo, int *hi);
+int load_run_index(const char *base_dir, const char *prefix, int64_t *dir_mtime,
+                   RunIndexEntry **entries, int *n_entries);
+int save_run_index(const char *base_dir, const char *prefix);
+void free_run_index_entry(RunIndexEntry *e);
+int run_index_load_header(PlotfileData *pf, int *header_levels);
+int run_index_load_level(const char *plotfile_dir, int level, Box **boxes, int *capacity,
+                         int *n_boxes, RangeIndex *ri);
+void run_index_store_level(const char *plotfile_dir, int level, const Box *boxes, int n_boxes,
+                           const RangeIndex *ri);
+void free_range_index(RangeIndex *ri);
+int range_index_valid(const RangeIndex *ri, int n_boxes, int var_idx);
+int range_index_volume(const RangeIndex *ri, int n_boxes, int var_idx, double *vmin, double *vmax);
+int slice_range_indexed(const double *slice, int width, int height, const Box *boxes, int n_boxes,
+                        const BoxIndex *index, const RangeIndex *ri, int var_idx, int axis,
+                        int slice_coord, const int *level_lo, double *vmin, double *vmax);
+int build_box_index(BoxIndex *bi, const Box *boxes, int n_boxes);
+void free_box_index(BoxIndex *bi);
+int box_index_plane(const BoxIndex *bi, const Box *boxes, int axis, int coord, int *hits);
+int box_index_find(const BoxIndex *bi, const Box *boxes, const int *cell);
+void box_slice_mask(unsigned char *mask, int width, int height, const Box *boxes,
+                    const int *hits, int n_hits, int axis, const int *level_lo);
+int variable_global_range(PlotfileData *pf, int var_idx, double *vmin, double *vmax);
 int read_variable_data(PlotfileData *pf, int var_idx);
+int parse_fab_on_disk(const char *line, Box *box);
+int parse_fab_header(const char *line, FabFormat *fmt);
+void decode_reals(double *dst, const char *src, size_t n, const FabFormat *fmt);
+void decode_reals_float(float *dst, const char *src, size_t n, const FabFormat *fmt);
+int *plan_box_reads(const Box *boxes, int n_boxes);
+int read_fab_components(const char *level_dir, const Box *boxes, int n_boxes,
+                        const int *vars, void **dests, int n_comps,
+                        const int *dims, const int *lo);
+int read_fab_component(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                       void *dest, const int *dims, const int *lo);
+int read_fab_component_packed(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                              void *dest, const size_t *box_offset);
+const MappedFile *map_cell_d_file(const char *level_dir, const char *filename);
+void release_mapped_files(void);
+int read_fab_plane(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                   int axis, int idx, double *plane, const int *dims, const int *lo);
+int read_variable_slice(PlotfileData *pf, int var_idx, int axis, int idx);
+int read_fab_zrange(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                    int z0, int nz, void *dest, const int *dims, const int *lo);
+const OocChunk *ooc_chunk(PlotfileData *pf, int var_idx, int z);
+size_t advise_timestep_reads(const char *plotfile_dir, int level, int ndim, int n_vars,
+                             int var_idx, int axis, int idx, int advice);
+int slice_cache_covers(const PlotfileData *pf, int var_idx);
+int slice_cache_read(const PlotfileData *pf, int var_idx, int axis, int idx, double *slice);
+int build_slice_cache(const char *base_dir, const char *prefix, const char *var_name, int axis);
+const StatsEntry *stats_cache_lookup(const char *plotfile_dir, int level, const char *var, int axis);
+int stats_cache_layer(const char *plotfile_dir, int level, const char *var, int axis, int s,
+                      double *m);
+void stats_cache_store(const char *plotfile_dir, int level, const char *var, int axis,
+                       int n_layers, const double *moments);
+int load_variable(PlotfileData *pf, int var_idx);
+int ensure_full_data(PlotfileData *pf);
+int field_available(PlotfileData *pf);
+void *field_cache_acquire(const char *dir, int level, int var_idx);
+void field_cache_insert(const char *dir, int level, int var_idx, void *data, size_t bytes);
+void field_cache_release(void *data);
+int field_cache_contains(const char *dir, int level, int var_idx);
+void prefetch_adopt(void);
+void prefetch_wait(const char *dir, int level, int var_idx);
+void schedule_prefetch(PlotfileData *pf);
+int load_resident_fields(PlotfileData *pf, const int *vars, int n_vars);
+void *resident_field(PlotfileData *pf, int var_idx);
+void free_resident_fields(PlotfileData *pf);
+int run_io_benchmark(const char *plotfile_dir);
+int run_io_check(const char *plotfile_dir, const char *variable);
 void extract_slice(PlotfileData *pf, double *slice, int axis, int idx);
-void extract_slice_level(LevelData *ld, double *slice, int axis, int idx);
+void box_plane_dims(const Box *box, int axis, int *width, int *height);
+void extract_level_box_plane(const LevelData *ld, int b, int axis, int coord, double *patch);
+int level_slice_range(const LevelData *ld, int var_idx, int axis, int coord,
+                      double *vmin, double *vmax);
 /* Multi-level overlay functions */
 int read_cell_h_level(PlotfileData *pf, int level);
 int read_variable_data_level(PlotfileData *pf, int var_idx, int level);
@@ -253,6 +672,15 @@ RGB cool_colormap(double t);
 RGB gray_colormap(double t);
 RGB magma_colormap(double t);
 RGB get_colormap_rgb(double t, int cmap_type);
+void set_pixel_format(const Visual *visual);
+int run_colormap_benchmark(int side);
+void create_frame_image(int width, int height);
+void destroy_frame_image(void);
+void image_fill_rect(int x, int y, int w, int h, unsigned long pixel);
+void image_flush(int x, int y, int w, int h);
+void put_cell_image(const unsigned long *pixels, const unsigned char *mask, int cw, int ch,
+                    int li0, int lj0, int lheight, int sx0, int sy0,
+                    double cell_w, double cell_h);
 const char *get_variable_unit(const char *varname);
 void draw_colorbar(double vmin, double vmax, int cmap_type, const char *varname);
 void cmap_button_callback(Widget w, XtPointer client_data, XtPointer call_data);
@@ -296,15 +724,21 @@ void variable_select_callback(Widget w, XtPointer client_data, XtPointer call_da
 void variable_selector_close_callback(Widget w, XtPointer client_data, XtPointer call_data);
 void render_quiver_overlay(PlotfileData *pf);
 void draw_arrow(Display *dpy, Drawable win, GC graphics_gc, int x1, int y1, int x2, int y2);
-void extract_slice_from_data(double *data, PlotfileData *pf, double *slice, int axis, int idx);
+void extract_slice_from_data(const void *data, PlotfileData *pf, double *slice, int axis, int idx);
+void extract_field_plane(const void *data, const int *dims, double *slice, int axis, int idx);
+void xtile_free(void);
 void update_layer_label(PlotfileData *pf);
 void canvas_expose_callback(Widget w, XtPointer client_data, XtPointer call_data);
+void expose_window(Window win, int x, int y, int w, int h);
 void canvas_motion_handler(Widget w, XtPointer client_data, XEvent *event, Boolean *continue_dispatch);
 void canvas_button_handler(Widget w, XtPointer client_data, XEvent *event, Boolean *continue_dispatch);
 void show_line_profiles(PlotfileData *pf, int data_x, int data_y);
 void cleanup(PlotfileData *pf);
 int scan_timesteps(const char *base_dir, const char *prefix);
 int scan_sdm_timesteps(const char *base_dir, const char *prefix);
+int poll_timestep_scan(int wait);
+void update_level_buttons(int total_levels);
+void scan_poll_timeout(XtPointer client_data, XtIntervalId *id);
 void switch_timestep(PlotfileData *pf, int new_timestep);
 void time_nav_button_callback(Widget w, XtPointer client_data, XtPointer call_data);
 void update_time_label(void);
@@ -439,6 +873,25 @@ void show_level_warning(int level) {
     XtPopup(warning_shell, XtGrabExclusive);
 }
 
+/* Grow the timeline arrays to hold at least n timesteps */
+int reserve_timesteps(int n) {
+    if (n <= timestep_capacity) return 0;
+    int cap = timestep_capacity > 0 ? timestep_capacity : 256;
+    while (cap < n) cap *= 2;
+
+    char **paths = (char **)realloc(timestep_paths, cap * sizeof(char *));
+    if (!paths) return -1;
+    timestep_paths = paths;
+    int *numbers = (int *)realloc(timestep_numbers, cap * sizeof(int));
+    if (!numbers) return -1;
+    timestep_numbers = numbers;
+    int *levels = (int *)realloc(timestep_levels, cap * sizeof(int));
+    if (!levels) return -1;
+    timestep_levels = levels;
+    timestep_capacity = cap;
+    return 0;
+}
+
 /* Comparison function for sorting timesteps */
 int compare_timesteps(const void *a, const void *b) {
     int idx_a = *(const int *)a;
@@ -446,173 +899,888 @@ int compare_timesteps(const void *a, const void *b) {
     return timestep_numbers[idx_a] - timestep_numbers[idx_b];
 }
 
-/* Scan directory for plotfiles and sort them by number */
-int scan_timesteps(const char *base_dir, const char *prefix) {
-    DIR *dir;
-    struct dirent *entry;
-    char check_path[MAX_PATH];
-    int indices[MAX_TIMESTEPS];
-    int temp_levels[MAX_TIMESTEPS];
-    int prefix_len = strlen(prefix);
+/* Sort the scanned timeline by timestep number */
+static void sort_timesteps(int with_levels) {
+    int *indices = (int *)malloc(n_timesteps * sizeof(int));
+    char **temp_paths = (char **)malloc(n_timesteps * sizeof(char *));
+    int *temp_numbers = (int *)malloc(n_timesteps * sizeof(int));
+    int *temp_levels = (int *)malloc(n_timesteps * sizeof(int));
+    if (!indices || !temp_paths || !temp_numbers || !temp_levels) {
+        free(indices);
+        free(temp_paths);
+        free(temp_numbers);
+        free(temp_levels);
+        return;  /* Leave directory order */
+    }
 
-    dir = opendir(base_dir);
-    if (!dir) {
-        fprintf(stderr, "Error: Cannot open directory %s\n", base_dir);
+    for (int i = 0; i < n_timesteps; i++) indices[i] = i;
+    qsort(indices, n_timesteps, sizeof(int), compare_timesteps);
+
+    /* Reorder arrays based on sorted indices */
+    for (int i = 0; i < n_timesteps; i++) {
+        temp_paths[i] = timestep_paths[indices[i]];
+        temp_numbers[i] = timestep_numbers[indices[i]];
+        temp_levels[i] = timestep_levels[indices[i]];
+    }
+    for (int i = 0; i < n_timesteps; i++) {
+        timestep_paths[i] = temp_paths[i];
+        timestep_numbers[i] = temp_numbers[i];
+        if (with_levels) timestep_levels[i] = temp_levels[i];
+    }
+
+    free(indices);
+    free(temp_paths);
+    free(temp_numbers);
+    free(temp_levels);
+}
+
+/* ========== Run Metadata Index ========== */
+
+/* Modification time in nanoseconds */
+static int64_t stat_mtime_ns(const struct stat *st) {
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+/* Raw index I/O; the first failure sticks in *err */
+static void index_put(FILE *fp, const void *p, size_t n, int *err) {
+    if (!*err && fwrite(p, 1, n, fp) != n) *err = 1;
+}
+
+static void index_get(FILE *fp, void *p, size_t n, int *err) {
+    if (!*err && fread(p, 1, n, fp) != n) *err = 1;
+}
+
+static void index_put_int(FILE *fp, int v, int *err) {
+    int32_t x = v;
+    index_put(fp, &x, sizeof(x), err);
+}
+
+static int index_get_int(FILE *fp, int *err) {
+    int32_t x = 0;
+    index_get(fp, &x, sizeof(x), err);
+    return x;
+}
+
+/* Release one entry's variable list and level layouts */
+void free_run_index_entry(RunIndexEntry *e) {
+    free(e->variables);
+    e->variables = NULL;
+    for (int l = 0; l < MAX_LEVELS; l++) {
+        free(e->levels[l].boxes);
+        e->levels[l].boxes = NULL;
+        e->levels[l].n_boxes = -1;
+        free_range_index(&e->levels[l].ranges);
+    }
+}
+
+/* Release the installed run index */
+static void free_run_index(void) {
+    for (int i = 0; i < n_run_index; i++) free_run_index_entry(&run_index[i]);
+    free(run_index);
+    run_index = NULL;
+    n_run_index = 0;
+    run_index_dir[0] = '\0';
+}
+
+/* Header summary of one entry */
+static void write_index_entry(FILE *fp, const RunIndexEntry *e, int *err) {
+    index_put(fp, e->name, sizeof(e->name), err);
+    index_put_int(fp, e->number, err);
+    index_put_int(fp, e->n_levels, err);
+    index_put_int(fp, e->header_levels, err);
+    index_put(fp, &e->mtime_ns, sizeof(e->mtime_ns), err);
+    index_put(fp, &e->time, sizeof(e->time), err);
+    index_put_int(fp, e->ndim, err);
+    index_put_int(fp, e->n_vars, err);
+    for (int i = 0; i < 3; i++) index_put_int(fp, e->grid_dims[i], err);
+    index_put(fp, e->prob_lo, sizeof(e->prob_lo), err);
+    index_put(fp, e->prob_hi, sizeof(e->prob_hi), err);
+    index_put_int(fp, e->ref_ratio, err);
+    index_put(fp, e->variables, (size_t)e->n_vars * sizeof(*e->variables), err);
+}
+
+static int read_index_entry(FILE *fp, RunIndexEntry *e, int *err) {
+    memset(e, 0, sizeof(RunIndexEntry));
+    for (int l = 0; l < MAX_LEVELS; l++) e->levels[l].n_boxes = -1;
+    index_get(fp, e->name, sizeof(e->name), err);
+    e->name[sizeof(e->name) - 1] = '\0';
+    e->number = index_get_int(fp, err);
+    e->n_levels = index_get_int(fp, err);
+    e->header_levels = index_get_int(fp, err);
+    index_get(fp, &e->mtime_ns, sizeof(e->mtime_ns), err);
+    index_get(fp, &e->time, sizeof(e->time), err);
+    e->ndim = index_get_int(fp, err);
+    e->n_vars = index_get_int(fp, err);
+    for (int i = 0; i < 3; i++) e->grid_dims[i] = index_get_int(fp, err);
+    index_get(fp, e->prob_lo, sizeof(e->prob_lo), err);
+    index_get(fp, e->prob_hi, sizeof(e->prob_hi), err);
+    e->ref_ratio = index_get_int(fp, err);
+    if (*err || e->n_vars < 0 || e->n_vars > 1 << 16 || e->n_levels < 1 || e->n_levels > MAX_LEVELS) {
+        *err = 1;
+        return -1;
+    }
+    e->variables = malloc((e->n_vars > 0 ? e->n_vars : 1) * sizeof(*e->variables));
+    if (!e->variables) {
+        *err = 1;
         return -1;
     }
+    index_get(fp, e->variables, (size_t)e->n_vars * sizeof(*e->variables), err);
+    for (int i = 0; i < e->n_vars; i++) e->variables[i][63] = '\0';
+    return *err ? -1 : 0;
+}
+
+/* One level layout record: entry name, level, boxes and range tables.
+ * Box files are stored as their Cell_D number; levels whose files are not
+ * named Cell_D_NNNNN are not indexed. */
+static int write_level_record(FILE *fp, const char *name, int level, const Box *boxes,
+                              int n_boxes, const RangeIndex *ri, int *err) {
+    char entry_name[64] = {0};
+    strncpy(entry_name, name, sizeof(entry_name) - 1);
+    index_put(fp, entry_name, sizeof(entry_name), err);
+    index_put_int(fp, level, err);
+    index_put_int(fp, n_boxes, err);
+    int n_tables = (ri->n_tables == 2 && ri->n_boxes == n_boxes) ? 2 : 0;
+    index_put_int(fp, n_tables ? ri->n_comps : 0, err);
+    for (int b = 0; b < n_boxes; b++) {
+        const Box *box = &boxes[b];
+        int64_t offset = box->offset;
+        for (int i = 0; i < 3; i++) index_put_int(fp, box->lo[i], err);
+        for (int i = 0; i < 3; i++) index_put_int(fp, box->hi[i], err);
+        index_put_int(fp, atoi(box->filename + 7), err);
+        index_put(fp, &offset, sizeof(offset), err);
+    }
+    if (n_tables) {
+        size_t n = (size_t)n_boxes * ri->n_comps;
+        index_put(fp, ri->min, n * sizeof(double), err);
+        index_put(fp, ri->max, n * sizeof(double), err);
+    }
+    return *err ? -1 : 0;
+}
+
+static int level_indexable(const Box *boxes, int n_boxes) {
+    char name[64];
+    for (int b = 0; b < n_boxes; b++) {
+        snprintf(name, sizeof(name), "Cell_D_%05d", atoi(boxes[b].filename + 7));
+        if (strncmp(boxes[b].filename, "Cell_D_", 7) != 0 || strcmp(name, boxes[b].filename) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
 
-    n_timesteps = 0;
-    max_levels_all_timesteps = 1;
+/* Read one level record into its entry (found by name) */
+static int read_level_record(FILE *fp, RunIndexEntry *entries, int n_entries) {
+    char name[64];
+    int err = 0;
+    index_get(fp, name, sizeof(name), &err);
+    if (err) return -1;
+    name[sizeof(name) - 1] = '\0';
+    int level = index_get_int(fp, &err);
+    int n_boxes = index_get_int(fp, &err);
+    int n_comps = index_get_int(fp, &err);
+    if (err || level < 0 || level >= MAX_LEVELS || n_boxes < 0 || n_comps < 0) return -1;
+
+    RunIndexLevel lev = {0};
+    lev.boxes = (Box *)calloc(n_boxes > 0 ? n_boxes : 1, sizeof(Box));
+    if (!lev.boxes) return -1;
+    lev.n_boxes = n_boxes;
+    for (int b = 0; b < n_boxes && !err; b++) {
+        Box *box = &lev.boxes[b];
+        int64_t offset = 0;
+        for (int i = 0; i < 3; i++) box->lo[i] = index_get_int(fp, &err);
+        for (int i = 0; i < 3; i++) box->hi[i] = index_get_int(fp, &err);
+        snprintf(box->filename, sizeof(box->filename), "Cell_D_%05d", index_get_int(fp, &err));
+        index_get(fp, &offset, sizeof(offset), &err);
+        box->offset = (long)offset;
+    }
+    if (n_comps > 0 && !err) {
+        size_t n = (size_t)n_boxes * n_comps;
+        lev.ranges.min = (double *)malloc(n * sizeof(double));
+        lev.ranges.max = (double *)malloc(n * sizeof(double));
+        if (!lev.ranges.min || !lev.ranges.max) {
+            err = 1;
+        } else {
+            index_get(fp, lev.ranges.min, n * sizeof(double), &err);
+            index_get(fp, lev.ranges.max, n * sizeof(double), &err);
+            lev.ranges.n_boxes = n_boxes;
+            lev.ranges.n_comps = n_comps;
+            lev.ranges.n_tables = 2;
+        }
+    }
+    if (err) {
+        free(lev.boxes);
+        free_range_index(&lev.ranges);
+        return -1;
+    }
 
-    while ((entry = readdir(dir)) != NULL && n_timesteps < MAX_TIMESTEPS) {
-        /* Check if entry starts with the specified prefix */
-        if (strncmp(entry->d_name, prefix, prefix_len) == 0) {
-            /* Ensure ALL characters after prefix are digits (to avoid plt matching plt2d) */
-            const char *suffix = entry->d_name + prefix_len;
-            int all_digits = 1;
-            if (*suffix == '\0') all_digits = 0;  /* Must have at least one digit */
-            for (const char *p = suffix; *p != '\0'; p++) {
-                if (!isdigit(*p)) {
-                    all_digits = 0;
-                    break;
+    for (int i = 0; i < n_entries; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            RunIndexLevel *dst = &entries[i].levels[level];
+            free(dst->boxes);
+            free_range_index(&dst->ranges);
+            *dst = lev;
+            return 0;
+        }
+    }
+    free(lev.boxes);
+    free_range_index(&lev.ranges);
+    return 0;
+}
+
+/* Read the run index of base_dir. dir_mtime receives the run directory
+ * mtime recorded when the index was written. Returns -1 when there is no
+ * usable index for this prefix. */
+int load_run_index(const char *base_dir, const char *prefix, int64_t *dir_mtime,
+                   RunIndexEntry **entries, int *n_entries) {
+    char path[MAX_PATH];
+    char magic[8], saved_prefix[64];
+    int err = 0;
+
+    *entries = NULL;
+    *n_entries = 0;
+    snprintf(path, MAX_PATH, "%s/%s", base_dir, RUN_INDEX_FILE);
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    index_get(fp, magic, sizeof(magic), &err);
+    int version = index_get_int(fp, &err);
+    int n = index_get_int(fp, &err);
+    index_get(fp, dir_mtime, sizeof(*dir_mtime), &err);
+    index_get(fp, saved_prefix, sizeof(saved_prefix), &err);
+    saved_prefix[sizeof(saved_prefix) - 1] = '\0';
+    if (err || memcmp(magic, RUN_INDEX_MAGIC, sizeof(magic)) != 0 ||
+        version != RUN_INDEX_VERSION || n < 0 || strcmp(saved_prefix, prefix) != 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    RunIndexEntry *list = (RunIndexEntry *)calloc(n > 0 ? n : 1, sizeof(RunIndexEntry));
+    if (!list) {
+        fclose(fp);
+        return -1;
+    }
+    int got = 0;
+    while (got < n && read_index_entry(fp, &list[got], &err) == 0) got++;
+    if (got < n) {
+        for (int i = 0; i <= got && i < n; i++) free_run_index_entry(&list[i]);
+        free(list);
+        fclose(fp);
+        return -1;
+    }
+
+    /* Level layouts appended since; a damaged tail is simply dropped */
+    while (read_level_record(fp, list, n) == 0) {
+    }
+    fclose(fp);
+
+    *entries = list;
+    *n_entries = n;
+    return 0;
+}
+
+/* Rewrite the installed run index, including every indexed layout. The
+ * run directory's mtime is recorded after the rename, which itself touches
+ * the directory. */
+int save_run_index(const char *base_dir, const char *prefix) {
+    char path[MAX_PATH], tmp_path[MAX_PATH];
+    char magic[8] = RUN_INDEX_MAGIC, saved_prefix[64] = {0};
+    int64_t dir_mtime = 0;
+    int err = 0;
+
+    if (snprintf(path, MAX_PATH, "%s/%s", base_dir, RUN_INDEX_FILE) >= MAX_PATH ||
+        snprintf(tmp_path, MAX_PATH, "%s.tmp", path) >= MAX_PATH) {
+        return -1;
+    }
+    strncpy(saved_prefix, prefix, sizeof(saved_prefix) - 1);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) return -1;  /* Read-only run directory: work without an index */
+
+    pthread_mutex_lock(&run_index_lock);
+    index_put(fp, magic, sizeof(magic), &err);
+    index_put_int(fp, RUN_INDEX_VERSION, &err);
+    index_put_int(fp, n_run_index, &err);
+    long mtime_pos = ftell(fp);
+    index_put(fp, &dir_mtime, sizeof(dir_mtime), &err);
+    index_put(fp, saved_prefix, sizeof(saved_prefix), &err);
+    for (int i = 0; i < n_run_index; i++) write_index_entry(fp, &run_index[i], &err);
+    for (int i = 0; i < n_run_index; i++) {
+        for (int l = 0; l < MAX_LEVELS; l++) {
+            const RunIndexLevel *lev = &run_index[i].levels[l];
+            if (lev->n_boxes < 0) continue;
+            write_level_record(fp, run_index[i].name, l, lev->boxes, lev->n_boxes, &lev->ranges, &err);
+        }
+    }
+    pthread_mutex_unlock(&run_index_lock);
+
+    if (fclose(fp) != 0) err = 1;
+    if (err || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    struct stat st;
+    if (stat(base_dir, &st) == 0 && (fp = fopen(path, "r+b")) != NULL) {
+        dir_mtime = stat_mtime_ns(&st);
+        if (fseek(fp, mtime_pos, SEEK_SET) == 0) {
+            fwrite(&dir_mtime, sizeof(dir_mtime), 1, fp);
+        }
+        fclose(fp);
+    }
+    return 0;
+}
+
+/* Entry of the installed run index for a plotfile directory, or NULL.
+ * The caller holds run_index_lock. */
+static RunIndexEntry *find_run_index_entry(const char *plotfile_dir) {
+    size_t len = strlen(run_index_dir);
+    if (len == 0 || strncmp(plotfile_dir, run_index_dir, len) != 0 || plotfile_dir[len] != '/') {
+        return NULL;
+    }
+    const char *name = plotfile_dir + len + 1;
+    for (int i = 0; i < n_run_index; i++) {
+        if (strcmp(run_index[i].name, name) == 0) return &run_index[i];
+    }
+    return NULL;
+}
+
+/* Fill pf's Header fields from the run index. Returns -1 when the
+ * plotfile is not indexed. */
+int run_index_load_header(PlotfileData *pf, int *header_levels) {
+    int ret = -1;
+    pthread_mutex_lock(&run_index_lock);
+    RunIndexEntry *e = find_run_index_entry(pf->plotfile_dir);
+    if (e) {
+        char (*names)[64] = realloc(pf->variables, (e->n_vars > 0 ? e->n_vars : 1) * sizeof(*names));
+        if (names) {
+            pf->variables = names;
+            memcpy(pf->variables, e->variables, (size_t)e->n_vars * sizeof(*names));
+            pf->n_vars = e->n_vars;
+            pf->ndim = e->ndim;
+            pf->time = e->time;
+            pf->n_levels = e->n_levels;
+            for (int i = 0; i < 3; i++) {
+                pf->prob_lo[i] = e->prob_lo[i];
+                pf->prob_hi[i] = e->prob_hi[i];
+            }
+            for (int i = 0; i < e->ndim && i < 3; i++) pf->grid_dims[i] = e->grid_dims[i];
+            pf->ref_ratio[0] = 1;
+            for (int i = 1; i < MAX_LEVELS; i++) pf->ref_ratio[i] = e->ref_ratio;
+            *header_levels = e->header_levels;
+            ret = 0;
+        }
+    }
+    pthread_mutex_unlock(&run_index_lock);
+    return ret;
+}
+
+/* Copy an indexed level layout into a box list and range index. Returns -1
+ * when the level has not been indexed. */
+int run_index_load_level(const char *plotfile_dir, int level, Box **boxes, int *capacity,
+                         int *n_boxes, RangeIndex *ri) {
+    int ret = -1;
+    if (level < 0 || level >= MAX_LEVELS) return -1;
+    pthread_mutex_lock(&run_index_lock);
+    RunIndexEntry *e = find_run_index_entry(plotfile_dir);
+    const RunIndexLevel *lev = e ? &e->levels[level] : NULL;
+    if (lev && lev->n_boxes >= 0 && reserve_boxes(boxes, capacity, lev->n_boxes) == 0) {
+        memcpy(*boxes, lev->boxes, (size_t)lev->n_boxes * sizeof(Box));
+        *n_boxes = lev->n_boxes;
+        free_range_index(ri);
+        if (lev->ranges.n_tables == 2) {
+            size_t n = (size_t)lev->ranges.n_boxes * lev->ranges.n_comps;
+            ri->min = (double *)malloc(n * sizeof(double));
+            ri->max = (double *)malloc(n * sizeof(double));
+            if (ri->min && ri->max) {
+                memcpy(ri->min, lev->ranges.min, n * sizeof(double));
+                memcpy(ri->max, lev->ranges.max, n * sizeof(double));
+                ri->n_boxes = lev->ranges.n_boxes;
+                ri->n_comps = lev->ranges.n_comps;
+                ri->n_tables = 2;
+            } else {
+                free_range_index(ri);
+            }
+        }
+        ret = 0;
+    }
+    pthread_mutex_unlock(&run_index_lock);
+    return ret;
+}
+
+/* Record a freshly parsed level layout in the run index and append it to
+ * the index file, so the next visit skips the Cell_H parse */
+void run_index_store_level(const char *plotfile_dir, int level, const Box *boxes, int n_boxes,
+                           const RangeIndex *ri) {
+    char path[MAX_PATH];
+    if (level < 0 || level >= MAX_LEVELS || !level_indexable(boxes, n_boxes)) return;
+
+    pthread_mutex_lock(&run_index_lock);
+    RunIndexEntry *e = find_run_index_entry(plotfile_dir);
+    if (e && e->levels[level].n_boxes < 0) {
+        RunIndexLevel *lev = &e->levels[level];
+        lev->boxes = (Box *)malloc((n_boxes > 0 ? n_boxes : 1) * sizeof(Box));
+        if (lev->boxes) {
+            memcpy(lev->boxes, boxes, (size_t)n_boxes * sizeof(Box));
+            lev->n_boxes = n_boxes;
+            if (ri->n_tables == 2 && ri->n_boxes == n_boxes) {
+                size_t n = (size_t)n_boxes * ri->n_comps;
+                lev->ranges.min = (double *)malloc(n * sizeof(double));
+                lev->ranges.max = (double *)malloc(n * sizeof(double));
+                if (lev->ranges.min && lev->ranges.max) {
+                    memcpy(lev->ranges.min, ri->min, n * sizeof(double));
+                    memcpy(lev->ranges.max, ri->max, n * sizeof(double));
+                    lev->ranges.n_boxes = n_boxes;
+                    lev->ranges.n_comps = ri->n_comps;
+                    lev->ranges.n_tables = 2;
+                } else {
+                    free_range_index(&lev->ranges);
                 }
             }
-            if (!all_digits) continue;
 
-            /* Check if it's a valid plotfile directory (has Header file) */
-            snprintf(check_path, MAX_PATH, "%s/%s/Header", base_dir, entry->d_name);
-            FILE *fp = fopen(check_path, "r");
+            FILE *fp = snprintf(path, MAX_PATH, "%s/%s", run_index_dir, RUN_INDEX_FILE) < MAX_PATH ?
+                       fopen(path, "ab") : NULL;
             if (fp) {
+                int err = 0;
+                write_level_record(fp, e->name, level, lev->boxes, lev->n_boxes, &lev->ranges, &err);
                 fclose(fp);
+            }
+        }
+    }
+    pthread_mutex_unlock(&run_index_lock);
+}
+
+/* Build an index entry for base_dir/name from its Header and Level_N
+ * directories. Returns -1 when the directory is not a plotfile. */
+static int build_index_entry(RunIndexEntry *e, const char *base_dir, const char *name, int number) {
+    char path[MAX_PATH];
+    struct stat st;
+    PlotfileData *tmp;
 
-                /* Extract number from plotfile name (after prefix) */
-                int num = atoi(entry->d_name + prefix_len);
+    if (snprintf(path, MAX_PATH, "%s/%s/Header", base_dir, name) >= MAX_PATH ||
+        stat(path, &st) != 0) {
+        return -1;
+    }
 
-                /* Allocate and store path */
-                timestep_paths[n_timesteps] = (char *)malloc(MAX_PATH);
-                snprintf(timestep_paths[n_timesteps], MAX_PATH, "%s/%s", base_dir, entry->d_name);
-                timestep_numbers[n_timesteps] = num;
+    tmp = (PlotfileData *)calloc(1, sizeof(PlotfileData));
+    if (!tmp) return -1;
+    memcpy(tmp->plotfile_dir, path, strlen(path) - strlen("/Header"));
+    int header_levels = 0;
+    if (parse_header(tmp, &header_levels) < 0) {
+        free(tmp->variables);
+        free(tmp);
+        return -1;
+    }
 
-                /* Detect levels for this timestep */
-                int levels = detect_levels_for_path(timestep_paths[n_timesteps]);
-                temp_levels[n_timesteps] = levels;
-                if (levels > max_levels_all_timesteps) {
-                    max_levels_all_timesteps = levels;
-                }
+    memset(e, 0, sizeof(RunIndexEntry));
+    strncpy(e->name, name, sizeof(e->name) - 1);
+    e->number = number;
+    e->n_levels = detect_levels(tmp);
+    if (e->n_levels > MAX_LEVELS) e->n_levels = MAX_LEVELS;
+    e->header_levels = header_levels;
+    e->mtime_ns = stat_mtime_ns(&st);
+    e->time = tmp->time;
+    e->ndim = tmp->ndim;
+    e->n_vars = tmp->n_vars;
+    e->variables = tmp->variables;
+    for (int i = 0; i < 3; i++) {
+        e->grid_dims[i] = tmp->grid_dims[i];
+        e->prob_lo[i] = tmp->prob_lo[i];
+        e->prob_hi[i] = tmp->prob_hi[i];
+    }
+    e->ref_ratio = tmp->ref_ratio[1];
+    for (int l = 0; l < MAX_LEVELS; l++) e->levels[l].n_boxes = -1;
+    free(tmp);
+    return 0;
+}
+
+/* Comparison function for index entries by directory name */
+static int compare_index_names(const void *a, const void *b) {
+    return strcmp(((const RunIndexEntry *)a)->name, ((const RunIndexEntry *)b)->name);
+}
+
+/* True when name is prefix followed by digits only (plt matches plt00100, not plt2d) */
+static int is_timestep_name(const char *name, const char *prefix) {
+    int prefix_len = strlen(prefix);
+    if (strncmp(name, prefix, prefix_len) != 0) return 0;
+    const char *suffix = name + prefix_len;
+    if (*suffix == '\0') return 0;  /* Must have at least one digit */
+    for (const char *p = suffix; *p != '\0'; p++) {
+        if (!isdigit((unsigned char)*p)) return 0;
+    }
+    return 1;
+}
+
+/* Comparison function for candidate directories by timestep number */
+static int compare_candidate_numbers(const void *a, const void *b) {
+    int na = ((const ScanCandidate *)a)->number;
+    int nb = ((const ScanCandidate *)b)->number;
+    return (na > nb) - (na < nb);
+}
+
+/* Validate one candidate: reuse its run index entry when the Header is
+ * unchanged, otherwise read the Header and count Level_N directories. SDM
+ * candidates only need their particle Header to exist. */
+static void validate_candidate(TimestepScan *scan, int i) {
+    char path[MAX_PATH];
+    struct stat st;
+    const char *name = scan->candidates[i].name;
+    RunIndexEntry *e = &scan->entries[i];
+
+    if (scan->sdm) {
+        int found = snprintf(path, MAX_PATH, "%s/%s/%s/Header", scan->base_dir, name, SDM_SUBDIR) < MAX_PATH &&
+                    stat(path, &st) == 0;
+        memset(e, 0, sizeof(RunIndexEntry));
+        e->n_levels = 1;
+        __atomic_store_n(&scan->state[i], found ? SCAN_VALID : SCAN_INVALID,
+                         __ATOMIC_RELEASE);
+        return;
+    }
 
-                indices[n_timesteps] = n_timesteps;
-                n_timesteps++;
+    RunIndexEntry key;
+    strncpy(key.name, name, sizeof(key.name) - 1);
+    key.name[sizeof(key.name) - 1] = '\0';
+    RunIndexEntry *hit = scan->n_old > 0 ?
+        (RunIndexEntry *)bsearch(&key, scan->old, scan->n_old, sizeof(RunIndexEntry), compare_index_names) : NULL;
+    if (hit && hit->variables) {
+        if (snprintf(path, MAX_PATH, "%s/%s/Header", scan->base_dir, name) < MAX_PATH &&
+            stat(path, &st) == 0 && stat_mtime_ns(&st) == hit->mtime_ns) {
+            *e = *hit;
+            hit->variables = NULL;  /* Ownership moved to the new entry */
+            for (int l = 0; l < MAX_LEVELS; l++) {
+                hit->levels[l].boxes = NULL;
+                memset(&hit->levels[l].ranges, 0, sizeof(RangeIndex));
             }
+            __atomic_fetch_add(&scan->reused, 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&scan->state[i], SCAN_VALID, __ATOMIC_RELEASE);
+            return;
         }
     }
 
-    closedir(dir);
+    if (build_index_entry(e, scan->base_dir, name, scan->candidates[i].number) == 0) {
+        __atomic_store_n(&scan->state[i], SCAN_VALID, __ATOMIC_RELEASE);
+    } else {
+        memset(e, 0, sizeof(RunIndexEntry));
+        __atomic_store_n(&scan->state[i], SCAN_INVALID, __ATOMIC_RELEASE);
+    }
+}
 
-    if (n_timesteps == 0) {
-        return -1;
+/* Scan worker: claim candidates in timestep order until none are left */
+static void *scan_worker(void *arg) {
+    TimestepScan *scan = (TimestepScan *)arg;
+    while (1) {
+        int i = __atomic_fetch_add(&scan->next, 1, __ATOMIC_RELAXED);
+        if (i >= scan->n) break;
+        validate_candidate(scan, i);
+        pthread_mutex_lock(&scan->lock);
+        scan->n_done++;
+        pthread_cond_broadcast(&scan->cond);
+        pthread_mutex_unlock(&scan->lock);
     }
+    return NULL;
+}
 
-    /* Sort indices by timestep number */
-    qsort(indices, n_timesteps, sizeof(int), compare_timesteps);
+/* Rebuild the timeline from every candidate not known to be invalid,
+ * keeping the current timestep on the same plotfile */
+static void rebuild_timeline(TimestepScan *scan) {
+    int current_slot = (n_timesteps > 0 && scan->slot) ? scan->slot[current_timestep] : 0;
 
-    /* Reorder arrays based on sorted indices */
-    char *temp_paths[MAX_TIMESTEPS];
-    int temp_numbers[MAX_TIMESTEPS];
-    int sorted_levels[MAX_TIMESTEPS];
+    for (int t = 0; t < n_timesteps; t++) free(timestep_paths[t]);
+    n_timesteps = 0;
+    current_timestep = 0;
 
-    for (int i = 0; i < n_timesteps; i++) {
-        temp_paths[i] = timestep_paths[indices[i]];
-        temp_numbers[i] = timestep_numbers[indices[i]];
-        sorted_levels[i] = temp_levels[indices[i]];
+    for (int i = 0; i < scan->n; i++) {
+        int state = __atomic_load_n(&scan->state[i], __ATOMIC_ACQUIRE);
+        if (state == SCAN_INVALID) continue;
+        if (reserve_timesteps(n_timesteps + 1) < 0) {
+            fprintf(stderr, "Error: Cannot allocate timestep list\n");
+            break;
+        }
+        timestep_paths[n_timesteps] = (char *)malloc(MAX_PATH);
+        if (!timestep_paths[n_timesteps] ||
+            snprintf(timestep_paths[n_timesteps], MAX_PATH, "%s/%s", scan->base_dir,
+                     scan->candidates[i].name) >= MAX_PATH) {
+            free(timestep_paths[n_timesteps]);
+            continue;
+        }
+        timestep_numbers[n_timesteps] = scan->candidates[i].number;
+        timestep_levels[n_timesteps] = state == SCAN_VALID ? scan->entries[i].n_levels : 1;
+        scan->slot[n_timesteps] = i;
+        if (i <= current_slot) current_timestep = n_timesteps;
+        n_timesteps++;
+    }
+    scan->n_invalid_seen = 0;
+    for (int i = 0; i < scan->n; i++) {
+        if (__atomic_load_n(&scan->state[i], __ATOMIC_ACQUIRE) == SCAN_INVALID) scan->n_invalid_seen++;
     }
+}
 
-    for (int i = 0; i < n_timesteps; i++) {
-        timestep_paths[i] = temp_paths[i];
-        timestep_numbers[i] = temp_numbers[i];
-        timestep_levels[i] = sorted_levels[i];
+/* Fold finished validations into the timeline. Level counts and
+ * max_levels_all_timesteps grow as plotfiles are validated; candidates
+ * found invalid are dropped. When everything is validated the workers are
+ * joined and the run index is installed and saved. With wait, blocks until
+ * then. Returns TIMESTEP_SCAN_* flags describing what changed. */
+int poll_timestep_scan(int wait) {
+    TimestepScan *scan = &timestep_scan;
+    int changes = 0;
+    if (!scan->active) return 0;
+
+    pthread_mutex_lock(&scan->lock);
+    while (wait && scan->n_done < scan->n) pthread_cond_wait(&scan->cond, &scan->lock);
+    int done = (scan->n_done == scan->n);
+    pthread_mutex_unlock(&scan->lock);
+
+    /* Drop plotfiles found invalid since the last poll */
+    int n_invalid = 0;
+    for (int i = 0; i < scan->n; i++) {
+        if (__atomic_load_n(&scan->state[i], __ATOMIC_ACQUIRE) == SCAN_INVALID) n_invalid++;
+    }
+    if (n_invalid != scan->n_invalid_seen) {
+        rebuild_timeline(scan);
+        changes |= TIMESTEP_SCAN_TIMELINE;
     }
 
-    printf("Found %d timesteps, max levels across all: %d\n", n_timesteps, max_levels_all_timesteps);
-    return n_timesteps;
-}
+    for (int t = 0; t < n_timesteps; t++) {
+        int i = scan->slot[t];
+        if (__atomic_load_n(&scan->state[i], __ATOMIC_ACQUIRE) != SCAN_VALID) continue;
+        timestep_levels[t] = scan->entries[i].n_levels;
+        if (timestep_levels[t] > max_levels_all_timesteps) {
+            max_levels_all_timesteps = timestep_levels[t];
+            changes |= TIMESTEP_SCAN_LEVELS;
+        }
+    }
+    if (!done) return changes;
 
-/* Scan directory for plotfiles with SDM data and sort them by number */
-int scan_sdm_timesteps(const char *base_dir, const char *prefix) {
-    DIR *dir;
+    for (int t = 0; t < scan->n_threads; t++) pthread_join(scan->threads[t], NULL);
+
+    if (!scan->sdm) {
+        /* Install the validated entries as the run index */
+        int n = 0;
+        for (int i = 0; i < scan->n; i++) {
+            if (scan->state[i] == SCAN_VALID) scan->entries[n++] = scan->entries[i];
+        }
+        pthread_mutex_lock(&run_index_lock);
+        run_index = scan->entries;
+        n_run_index = n;
+        strncpy(run_index_dir, scan->base_dir, MAX_PATH - 1);
+        run_index_dir[MAX_PATH - 1] = '\0';
+        pthread_mutex_unlock(&run_index_lock);
+        scan->entries = NULL;
+
+        if (n > 0 && save_run_index(scan->base_dir, scan->prefix) == 0) {
+            printf("Wrote %s/%s (%d of %d plotfiles reused)\n", scan->base_dir, RUN_INDEX_FILE,
+                   scan->reused, n);
+        }
+    }
+    printf("Validated %d %stimesteps, max levels across all: %d\n", n_timesteps,
+           scan->sdm ? "SDM " : "", max_levels_all_timesteps);
+
+    for (int i = 0; i < scan->n_old; i++) free_run_index_entry(&scan->old[i]);
+    free(scan->old);
+    free(scan->entries);
+    free(scan->candidates);
+    free(scan->state);
+    free(scan->slot);
+    pthread_mutex_destroy(&scan->lock);
+    pthread_cond_destroy(&scan->cond);
+    memset(scan, 0, sizeof(TimestepScan));
+    return changes | TIMESTEP_SCAN_DONE;
+}
+
+/* List candidate directories and validate them on a thread pool. Returns
+ * once the first plotfile in timestep order is validated; the rest are
+ * folded in by poll_timestep_scan. Returns the number of timesteps on the
+ * (provisional) timeline, or -1. */
+static int start_timestep_scan(DIR *dir, const char *base_dir, const char *prefix, int sdm,
+                               RunIndexEntry *old, int n_old) {
+    TimestepScan *scan = &timestep_scan;
     struct dirent *entry;
-    char check_path[MAX_PATH];
-    int indices[MAX_TIMESTEPS];
-    int prefix_len = strlen(prefix);
+    int capacity = 0;
 
-    dir = opendir(base_dir);
-    if (!dir) {
-        fprintf(stderr, "Error: Cannot open directory %s\n", base_dir);
+    memset(scan, 0, sizeof(TimestepScan));
+    strncpy(scan->base_dir, base_dir, MAX_PATH - 1);
+    strncpy(scan->prefix, prefix, sizeof(scan->prefix) - 1);
+    scan->sdm = sdm;
+    scan->old = old;
+    scan->n_old = n_old;
+    qsort(old, n_old, sizeof(RunIndexEntry), compare_index_names);
+
+    /* Listing the directory is one cheap pass; validation is the slow part */
+    while ((entry = readdir(dir)) != NULL) {
+        size_t name_len = strlen(entry->d_name);
+        if (!is_timestep_name(entry->d_name, prefix) ||
+            name_len >= sizeof(scan->candidates->name)) continue;
+        if (scan->n >= capacity) {
+            int cap = capacity > 0 ? capacity * 2 : 256;
+            ScanCandidate *grown = realloc(scan->candidates, cap * sizeof(ScanCandidate));
+            if (!grown) break;
+            scan->candidates = grown;
+            capacity = cap;
+        }
+        memcpy(scan->candidates[scan->n].name, entry->d_name, name_len + 1);
+        scan->candidates[scan->n].number = atoi(entry->d_name + strlen(prefix));
+        scan->n++;
+    }
+    closedir(dir);
+
+    qsort(scan->candidates, scan->n, sizeof(ScanCandidate), compare_candidate_numbers);
+
+    int n = scan->n > 0 ? scan->n : 1;
+    scan->entries = (RunIndexEntry *)calloc(n, sizeof(RunIndexEntry));
+    scan->state = (unsigned char *)calloc(n, 1);
+    scan->slot = (int *)calloc(n, sizeof(int));
+    pthread_mutex_init(&scan->lock, NULL);
+    pthread_cond_init(&scan->cond, NULL);
+    scan->active = 1;
+    if (!scan->entries || !scan->state || !scan->slot) {
+        fprintf(stderr, "Error: Cannot allocate timestep list\n");
+        scan->n = 0;
+        poll_timestep_scan(1);
         return -1;
     }
 
-    n_timesteps = 0;
+    scan->n_threads = scan->n < SCAN_THREADS ? scan->n : SCAN_THREADS;
+    for (int t = 0; t < scan->n_threads; t++) {
+        if (pthread_create(&scan->threads[t], NULL, scan_worker, scan) != 0) {
+            scan->n_threads = t;
+            break;
+        }
+    }
+    if (scan->n_threads == 0) scan_worker(scan);
 
-    while ((entry = readdir(dir)) != NULL && n_timesteps < MAX_TIMESTEPS) {
-        if (strncmp(entry->d_name, prefix, prefix_len) == 0) {
-            const char *suffix = entry->d_name + prefix_len;
-            int all_digits = 1;
-            if (*suffix == '\0') all_digits = 0;
-            for (const char *p = suffix; *p != '\0'; p++) {
-                if (!isdigit(*p)) {
-                    all_digits = 0;
-                    break;
-                }
-            }
-            if (!all_digits) continue;
+    /* Wait until the first candidate in order is known valid */
+    pthread_mutex_lock(&scan->lock);
+    int first = 0;
+    while (first < scan->n) {
+        int st = __atomic_load_n(&scan->state[first], __ATOMIC_ACQUIRE);
+        if (st == SCAN_VALID) break;
+        if (st == SCAN_INVALID) {
+            first++;
+            continue;
+        }
+        pthread_cond_wait(&scan->cond, &scan->lock);
+    }
+    pthread_mutex_unlock(&scan->lock);
 
-            /* Check for SDM subdirectory Header */
-            snprintf(check_path, MAX_PATH, "%s/%s/%s/Header",
-                     base_dir, entry->d_name, SDM_SUBDIR);
-            FILE *fp = fopen(check_path, "r");
-            if (fp) {
-                fclose(fp);
+    n_timesteps = 0;
+    rebuild_timeline(scan);
+    current_timestep = 0;
+    if (n_timesteps == 0 || first >= scan->n) {
+        poll_timestep_scan(1);
+        n_timesteps = 0;
+        return -1;
+    }
+    poll_timestep_scan(0);
+    if (scan->active) {
+        printf("Found %d %scandidates; validating the rest in the background\n", n_timesteps,
+               sdm ? "SDM " : "");
+    }
+    return n_timesteps;
+}
 
-                int num = atoi(entry->d_name + prefix_len);
+/* Scan directory for plotfiles and sort them by number. The run index is
+ * used as is while the directory is unchanged. Otherwise the listing is
+ * validated by a thread pool, reusing indexed plotfiles whose Header is
+ * unchanged, and this returns as soon as the first plotfile is known good;
+ * level counts fill in through poll_timestep_scan. */
+int scan_timesteps(const char *base_dir, const char *prefix) {
+    DIR *dir;
+    struct stat st;
 
-                timestep_paths[n_timesteps] = (char *)malloc(MAX_PATH);
-                snprintf(timestep_paths[n_timesteps], MAX_PATH, "%s/%s", base_dir, entry->d_name);
-                timestep_numbers[n_timesteps] = num;
-                indices[n_timesteps] = n_timesteps;
-                n_timesteps++;
-            }
-        }
+    if (stat(base_dir, &st) != 0 || (dir = opendir(base_dir)) == NULL) {
+        fprintf(stderr, "Error: Cannot open directory %s\n", base_dir);
+        return -1;
     }
 
+    n_timesteps = 0;
+    max_levels_all_timesteps = 1;
+    free_run_index();
+
+    RunIndexEntry *old = NULL;
+    int n_old = 0;
+    int64_t old_mtime = 0;
+    int have_index = (load_run_index(base_dir, prefix, &old_mtime, &old, &n_old) == 0);
+
+    if (!have_index || old_mtime != stat_mtime_ns(&st)) {
+        return start_timestep_scan(dir, base_dir, prefix, 0, old, n_old);
+    }
+
+    /* A plotfile rewritten in place leaves the directory mtime alone, so
+     * each Header is checked as the scan would; any change rescans, which
+     * still reuses the entries that match */
+    for (int i = 0; i < n_old; i++) {
+        char path[MAX_PATH];
+        struct stat hst;
+        if (snprintf(path, MAX_PATH, "%s/%s/Header", base_dir, old[i].name) >= MAX_PATH ||
+            stat(path, &hst) != 0 || stat_mtime_ns(&hst) != old[i].mtime_ns) {
+            return start_timestep_scan(dir, base_dir, prefix, 0, old, n_old);
+        }
+    }
     closedir(dir);
 
+    /* Nothing was added, removed or rewritten since the index was written */
+    pthread_mutex_lock(&run_index_lock);
+    run_index = old;
+    n_run_index = n_old;
+    strncpy(run_index_dir, base_dir, MAX_PATH - 1);
+    run_index_dir[MAX_PATH - 1] = '\0';
+    pthread_mutex_unlock(&run_index_lock);
+
+    for (int i = 0; i < n_old; i++) {
+        if (reserve_timesteps(n_timesteps + 1) < 0) {
+            fprintf(stderr, "Error: Cannot allocate timestep list\n");
+            break;
+        }
+        timestep_paths[n_timesteps] = (char *)malloc(MAX_PATH);
+        snprintf(timestep_paths[n_timesteps], MAX_PATH, "%s/%s", base_dir, old[i].name);
+        timestep_numbers[n_timesteps] = old[i].number;
+        timestep_levels[n_timesteps] = old[i].n_levels;
+        if (old[i].n_levels > max_levels_all_timesteps) {
+            max_levels_all_timesteps = old[i].n_levels;
+        }
+        n_timesteps++;
+    }
+
     if (n_timesteps == 0) {
         return -1;
     }
 
-    /* Sort indices by timestep number */
-    qsort(indices, n_timesteps, sizeof(int), compare_timesteps);
+    sort_timesteps(1);
 
-    char *temp_paths[MAX_TIMESTEPS];
-    int temp_numbers[MAX_TIMESTEPS];
+    printf("Using %s/%s\n", base_dir, RUN_INDEX_FILE);
+    printf("Found %d timesteps, max levels across all: %d\n", n_timesteps, max_levels_all_timesteps);
+    return n_timesteps;
+}
 
-    for (int i = 0; i < n_timesteps; i++) {
-        temp_paths[i] = timestep_paths[indices[i]];
-        temp_numbers[i] = timestep_numbers[indices[i]];
+/* Scan directory for plotfiles with SDM data and sort them by number. The
+ * particle Header checks run on the scan thread pool and are waited for. */
+int scan_sdm_timesteps(const char *base_dir, const char *prefix) {
+    DIR *dir = opendir(base_dir);
+    if (!dir) {
+        fprintf(stderr, "Error: Cannot open directory %s\n", base_dir);
+        return -1;
     }
 
-    for (int i = 0; i < n_timesteps; i++) {
-        timestep_paths[i] = temp_paths[i];
-        timestep_numbers[i] = temp_numbers[i];
+    n_timesteps = 0;
+    if (start_timestep_scan(dir, base_dir, prefix, 1, NULL, 0) < 0) {
+        return -1;
     }
+    poll_timestep_scan(1);
 
     printf("Found %d SDM timesteps\n", n_timesteps);
-    return n_timesteps;
+    return n_timesteps > 0 ? n_timesteps : -1;
 }
 
 /* Switch to a different timestep */
 void switch_timestep(PlotfileData *pf, int new_timestep) {
     if (new_timestep < 0 || new_timestep >= n_timesteps) return;
 
+    /* Remember which way the user is stepping for the prefetcher */
+    if (new_timestep == (current_timestep + 1) % n_timesteps) {
+        step_direction = 1;
+    } else if (new_timestep == (current_timestep - 1 + n_timesteps) % n_timesteps) {
+        step_direction = -1;
+    }
+
     current_timestep = new_timestep;
 
     /* Update plotfile directory */
@@ -620,6 +1788,8 @@ void switch_timestep(PlotfileData *pf, int new_timestep) {
 
     /* Always free old overlay data before reading new timestep */
     free_all_levels(pf);
+    release_mapped_files();
+    xtile_free();
 
     /* Save overlay_mode before read_header (which resets it) */
     int saved_overlay_mode = pf->overlay_mode;
@@ -646,8 +1816,9 @@ void switch_timestep(PlotfileData *pf, int new_timestep) {
         pf->slice_idx = max_idx;
     }
 
-    /* Re-read variable data */
-    read_variable_data(pf, pf->current_var);
+    /* Re-read variable data, picking up a prefetched copy if there is one */
+    prefetch_wait(pf->plotfile_dir, pf->current_level, pf->current_var);
+    load_variable(pf, pf->current_var);
 
     /* If overlay mode is on, reload all levels for new timestep */
     /* Don't change overlay_mode or button label - just reload data if needed */
@@ -662,6 +1833,8 @@ void switch_timestep(PlotfileData *pf, int new_timestep) {
     update_layer_label(pf);
     update_info_label(pf);
     render_slice(pf);
+
+    schedule_prefetch(pf);
 }
 
 /* Update time step label */
@@ -874,17 +2047,18 @@ void time_jump_button_callback(Widget w, XtPointer client_data, XtPointer call_d
 
 /* Time Series button callback */
 void time_series_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf && global_pf->data && n_timesteps > 1) {
+    if (global_pf && field_available(global_pf) && n_timesteps > 1) {
         show_time_series(global_pf);
     }
 }
 
-/* Read Header file */
-int read_header(PlotfileData *pf) {
+/* Parse a plotfile Header: variables, dimensionality, time, domain and the
+ * level 0 grid. header_levels receives the level count the Header states. */
+int parse_header(PlotfileData *pf, int *header_levels) {
     char path[MAX_PATH];
     char line[MAX_LINE];
     FILE *fp;
-    int i, idx = 0;
+    int i;
     
     snprintf(path, MAX_PATH, "%s/Header", pf->plotfile_dir);
     fp = fopen(path, "r");
@@ -899,8 +2073,16 @@ int read_header(PlotfileData *pf) {
     /* Line 1: number of variables */
     fgets(line, MAX_LINE, fp);
     pf->n_vars = atoi(line);
-    
+    if (pf->n_vars < 0) pf->n_vars = 0;
+
     /* Variable names */
+    char (*names)[64] = realloc(pf->variables, (pf->n_vars > 0 ? pf->n_vars : 1) * sizeof(*names));
+    if (!names) {
+        fprintf(stderr, "Error: Cannot allocate %d variable names\n", pf->n_vars);
+        fclose(fp);
+        return -1;
+    }
+    pf->variables = names;
     for (i = 0; i < pf->n_vars; i++) {
         fgets(line, MAX_LINE, fp);
         line[strcspn(line, "\n")] = 0;  /* Remove newline */
@@ -917,7 +2099,7 @@ int read_header(PlotfileData *pf) {
     
     /* Number of levels - read from Header but verify by scanning directories */
     fgets(line, MAX_LINE, fp);
-    int header_levels = atoi(line);
+    *header_levels = atoi(line);
 
     /* Read prob_lo (domain lower bounds) */
     fgets(line, MAX_LINE, fp);
@@ -938,9 +2120,6 @@ int read_header(PlotfileData *pf) {
     for (i = 1; i < MAX_LEVELS; i++) {
         pf->ref_ratio[i] = (ref > 0) ? ref : 2;  /* Default to 2 if not parsed */
     }
-    /* Initialize overlay mode to off */
-    pf->overlay_mode = 0;
-    pf->map_mode = 0;
     
     /* Domain box */
     fgets(line, MAX_LINE, fp);
@@ -964,10 +2143,24 @@ int read_header(PlotfileData *pf) {
     }
     
     fclose(fp);
-    
-    /* Detect actual levels by scanning directories */
-    pf->n_levels = detect_levels(pf);
-    
+    return 0;
+}
+
+/* Read Header file, or take it from the run index when the run has one */
+int read_header(PlotfileData *pf) {
+    int i, header_levels = 0;
+
+    if (run_index_load_header(pf, &header_levels) < 0) {
+        if (parse_header(pf, &header_levels) < 0) return -1;
+
+        /* Detect actual levels by scanning directories */
+        pf->n_levels = detect_levels(pf);
+    }
+
+    /* Initialize overlay mode to off */
+    pf->overlay_mode = 0;
+    pf->map_mode = 0;
+    
     printf("Loaded: %s\n", pf->plotfile_dir);
     printf("Variables: %d (", pf->n_vars);
     for (i = 0; i < pf->n_vars && i < 5; i++) {
@@ -985,156 +2178,3435 @@ int read_header(PlotfileData *pf) {
     return 0;
 }
 
-/* Read Cell_H to get box layout and FabOnDisk mapping */
-int read_cell_h(PlotfileData *pf) {
+/* Parse a "FabOnDisk: Cell_D_XXXXX <offset>" line into a box */
+int parse_fab_on_disk(const char *line, Box *box) {
+    char name[64];
+    long offset = 0;
+
+    if (sscanf(line, "FabOnDisk: %63s %ld", name, &offset) < 1) return -1;
+    strncpy(box->filename, name, 63);
+    box->filename[63] = '\0';
+    box->offset = offset;
+    return 0;
+}
+
+/* Parse the real descriptor of a Cell_D FAB header line, e.g.
+ *   FAB ((8, (64 11 52 0 1 12 0 1023)),(8, (8 7 6 5 4 3 2 1)))((lo) (hi) (0,0,0)) ncomp
+ * The first tuple describes the floating-point format (first entry is the
+ * bit width), the second gives the element size and byte order: 8 7 ... 1
+ * is little-endian, 1 2 ... 8 is big-endian. Unknown descriptors fall back
+ * to native doubles and return -1. */
+int parse_fab_header(const char *line, FabFormat *fmt) {
+    static int warned = 0;
+    const uint16_t probe = 1;
+    int host_little = *(const uint8_t *)&probe;
+    int nfields, bits, nbytes, first;
+
+    fmt->elem_size = 8;
+    fmt->swap = 0;
+
+    if (sscanf(line, "FAB ((%d, (%d", &nfields, &bits) == 2) {
+        const char *p = strstr(line, "),(");
+        if (p && sscanf(p, "),(%d, (%d", &nbytes, &first) == 2 &&
+            bits == nbytes * 8 && (nbytes == 4 || nbytes == 8) &&
+            (first == 1 || first == nbytes)) {
+            int file_little = (first == nbytes);
+            fmt->elem_size = nbytes;
+            fmt->swap = (file_little != host_little);
+            return 0;
+        }
+    }
+    if (!warned) {
+        fprintf(stderr, "Warning: Unrecognized FAB descriptor, assuming native doubles\n");
+        warned = 1;
+    }
+    return -1;
+}
+
+/* Convert n on-disk reals to T. Each format gets its own plain loop so the
+ * compiler can vectorize the byte swaps, widening and narrowing. */
+#define DEFINE_DECODE_REALS(name, T)                                    \
+void name(T *dst, const char *src, size_t n, const FabFormat *fmt) {    \
+    if (fmt->elem_size == (int)sizeof(T) && !fmt->swap) {               \
+        memcpy(dst, src, n * sizeof(T));                                \
+    } else if (fmt->elem_size == 8 && !fmt->swap) {                     \
+        for (size_t i = 0; i < n; i++) {                                \
+            double d;                                                   \
+            memcpy(&d, src + i * 8, 8);                                 \
+            dst[i] = (T)d;                                              \
+        }                                                               \
+    } else if (fmt->elem_size == 8) {                                   \
+        for (size_t i = 0; i < n; i++) {                                \
+            uint64_t u;                                                 \
+            double d;                                                   \
+            memcpy(&u, src + i * 8, 8);                                 \
+            u = __builtin_bswap64(u);                                   \
+            memcpy(&d, &u, 8);                                          \
+            dst[i] = (T)d;                                              \
+        }                                                               \
+    } else if (!fmt->swap) {                                            \
+        for (size_t i = 0; i < n; i++) {                                \
+            float f;                                                    \
+            memcpy(&f, src + i * 4, 4);                                 \
+            dst[i] = (T)f;                                              \
+        }                                                               \
+    } else {                                                            \
+        for (size_t i = 0; i < n; i++) {                                \
+            uint32_t u;                                                 \
+            float f;                                                    \
+            memcpy(&u, src + i * 4, 4);                                 \
+            u = __builtin_bswap32(u);                                   \
+            memcpy(&f, &u, 4);                                          \
+            dst[i] = (T)f;                                              \
+        }                                                               \
+    }                                                                   \
+}
+
+DEFINE_DECODE_REALS(decode_reals, double)
+DEFINE_DECODE_REALS(decode_reals_float, float)
+
+/* Comparison function for box read order: group by file, then by offset.
+ * Sorts Box pointers so that no shared state is needed; the prefetch
+ * thread plans reads while the UI thread does. */
+int compare_box_reads(const void *a, const void *b) {
+    const Box *ba = *(const Box *const *)a;
+    const Box *bb = *(const Box *const *)b;
+    int c = strcmp(ba->filename, bb->filename);
+    if (c != 0) return c;
+    if (ba->offset < bb->offset) return -1;
+    if (ba->offset > bb->offset) return 1;
+    return 0;
+}
+
+/* Build the read order for a set of boxes so that every Cell_D file is
+ * visited once and read front to back. Returns a malloc'd index array. */
+int *plan_box_reads(const Box *boxes, int n_boxes) {
+    int *order = (int *)malloc((n_boxes > 0 ? n_boxes : 1) * sizeof(int));
+    const Box **sorted = (const Box **)malloc((n_boxes > 0 ? n_boxes : 1) * sizeof(Box *));
+    if (!order || !sorted) {
+        free(order);
+        free(sorted);
+        return NULL;
+    }
+    for (int i = 0; i < n_boxes; i++) sorted[i] = &boxes[i];
+
+    qsort(sorted, n_boxes, sizeof(Box *), compare_box_reads);
+    for (int i = 0; i < n_boxes; i++) order[i] = (int)(sorted[i] - boxes);
+    free(sorted);
+    return order;
+}
+
+/* Level directory of a plotfile, "<plotfile>/Level_N". Returns -1 when
+ * the path does not fit in MAX_PATH. */
+static int level_dir_path(char *level_dir, const char *plotfile_dir, int level) {
+    return snprintf(level_dir, MAX_PATH, "%s/Level_%d", plotfile_dir, level) < MAX_PATH ? 0 : -1;
+}
+
+/* Wall clock in seconds, for load timing */
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Bytes of one component summed over a set of boxes */
+static double fab_component_mb(const Box *boxes, int n_boxes) {
+    double bytes = 0;
+    for (int b = 0; b < n_boxes; b++) {
+        bytes += (double)(boxes[b].hi[0] - boxes[b].lo[0] + 1) *
+                 (boxes[b].hi[1] - boxes[b].lo[1] + 1) *
+                 (boxes[b].hi[2] - boxes[b].lo[2] + 1) * sizeof(double);
+    }
+    return bytes / (1024.0 * 1024.0);
+}
+
+/* Copy one box component from its on-disk (Fortran order) bytes into a dense
+ * (Z, Y, X) field of FIELD_ELEM_SIZE elements. X varies fastest in both layouts, so each X row is one
+ * contiguous decode. Rows past the end of a short FAB are left untouched. */
+static void scatter_box(const Box *box, const char *src, size_t avail, const FabFormat *fmt,
+                        void *dest, const int *dims, const int *lo) {
+    int box_dims[3];
+    for (int d = 0; d < 3; d++) {
+        box_dims[d] = box->hi[d] - box->lo[d] + 1;
+    }
+    size_t row_bytes = (size_t)box_dims[0] * fmt->elem_size;
+    size_t pos = 0;
+
+    avail -= avail % fmt->elem_size;  /* Drop a trailing partial value */
+
+    for (int k = 0; k < box_dims[2]; k++) {
+        int gz = box->lo[2] + k - lo[2];
+        for (int j = 0; j < box_dims[1]; j++) {
+            if (pos >= avail) return;
+            int gy = box->lo[1] + j - lo[1];
+            int gx = box->lo[0] - lo[0];
+            size_t gidx = ((size_t)gz * dims[1] + gy) * dims[0] + gx;
+            size_t n = (avail - pos < row_bytes) ? avail - pos : row_bytes;
+            if (field_float32) {
+                decode_reals_float((float *)dest + gidx, src + pos, n / fmt->elem_size, fmt);
+            } else {
+                decode_reals((double *)dest + gidx, src + pos, n / fmt->elem_size, fmt);
+            }
+            pos += row_bytes;
+        }
+    }
+}
+
+/* Release all Cell_D mappings held for the current timestep */
+void release_mapped_files(void) {
+    for (int i = 0; i < n_mapped_files; i++) {
+        if (mapped_files[i].addr) {
+            munmap((void *)mapped_files[i].addr, mapped_files[i].length);
+        }
+    }
+    n_mapped_files = 0;
+    mapped_timestep_dir[0] = '\0';
+}
+
+/* Map a Cell_D file read-only, reusing the mapping if this timestep already
+ * has it. Mappings from a different timestep are dropped first. Returns
+ * NULL when the file cannot be mapped or the table is full. */
+const MappedFile *map_cell_d_file(const char *level_dir, const char *filename) {
+    char timestep_dir[MAX_PATH];
     char path[MAX_PATH];
+
+    /* level_dir is "<plotfile>/Level_N"; all levels share one timestep */
+    strncpy(timestep_dir, level_dir, MAX_PATH - 1);
+    timestep_dir[MAX_PATH - 1] = '\0';
+    char *slash = strrchr(timestep_dir, '/');
+    if (slash) *slash = '\0';
+    if (strcmp(timestep_dir, mapped_timestep_dir) != 0) {
+        release_mapped_files();
+        memcpy(mapped_timestep_dir, timestep_dir, MAX_PATH);
+    }
+
+    snprintf(path, MAX_PATH, "%s/%s", level_dir, filename);
+    for (int i = 0; i < n_mapped_files; i++) {
+        if (strcmp(mapped_files[i].path, path) == 0) return &mapped_files[i];
+    }
+
+    /* Mappings handed out earlier may be in use by the read being planned,
+     * so a full table is never evicted; the caller reads this file with
+     * stdio instead */
+    if (n_mapped_files >= MAX_MAPPED_FILES) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  /* The mapping stays valid after the descriptor is closed */
+    if (addr == MAP_FAILED) return NULL;
+
+    MappedFile *mf = &mapped_files[n_mapped_files++];
+    memcpy(mf->path, path, MAX_PATH);
+    mf->addr = (const char *)addr;
+    mf->length = (size_t)st.st_size;
+    return mf;
+}
+
+/* Shared state for one load, split across the I/O worker threads. Workers
+ * claim boxes from next_box and read every requested component of a box
+ * before moving on; boxes never overlap in dest, so the scatter needs no
+ * locking. */
+typedef struct {
+    const char *level_dir;
+    const Box *boxes;
+    const int *order;
+    const MappedFile **maps;   /* Per planned box, mmap backend only */
+    int n_boxes;
+    const int *vars;           /* Components to read, ascending */
+    void **dests;              /* One dense field per component */
+    int n_comps;
+    const int *dims;
+    const int *lo;
+    const size_t *box_offset;  /* Packed per-box dests, or NULL for dense */
+    int backend;               /* IO_BACKEND_STDIO, _MMAP or _URING */
+    size_t max_box_size;
+    int next_box;
+    int failed;
+} FabReadJob;
+
+/* Scatter one box component into its destination: the dense field, or the
+ * box's own array when the job fills packed per-box storage */
+static void scatter_job_box(const FabReadJob *job, int b, const char *src, size_t avail,
+                            const FabFormat *fmt, int c) {
+    const Box *box = &job->boxes[b];
+    if (!job->box_offset) {
+        scatter_box(box, src, avail, fmt, job->dests[c], job->dims, job->lo);
+        return;
+    }
+    int box_dims[3];
+    for (int d = 0; d < 3; d++) {
+        box_dims[d] = box->hi[d] - box->lo[d] + 1;
+    }
+    char *dest = (char *)job->dests[c] + job->box_offset[b] * FIELD_ELEM_SIZE;
+    scatter_box(box, src, avail, fmt, dest, box_dims, box->lo);
+}
+
+/* mmap backend: scatter straight from the mapped pages, no staging buffer */
+static void read_fab_box_mmap(FabReadJob *job, int n) {
+    const Box *box = &job->boxes[job->order[n]];
+    const MappedFile *mf = job->maps[n];
+    size_t box_size = (size_t)(box->hi[0] - box->lo[0] + 1) *
+                      (box->hi[1] - box->lo[1] + 1) *
+                      (box->hi[2] - box->lo[2] + 1);
+
+    /* A box without a readable header is missing: the load fails */
+    if (!mf || box->offset < 0 || (size_t)box->offset >= mf->length) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    /* Parse the FAB header line; components follow back to back */
     char line[MAX_LINE];
-    FILE *fp;
-    int i;
-    
-    snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", pf->plotfile_dir, pf->current_level);
-    fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot open %s\n", path);
+    FabFormat fmt;
+    const char *p = mf->addr + box->offset;
+    const char *end = mf->addr + mf->length;
+    const char *nl = memchr(p, '\n', end - p);
+    if (!nl) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    size_t hdr_len = (size_t)(nl - p) < MAX_LINE - 1 ? (size_t)(nl - p) : MAX_LINE - 1;
+    memcpy(line, p, hdr_len);
+    line[hdr_len] = '\0';
+    parse_fab_header(line, &fmt);
+    size_t data_start = (size_t)(nl + 1 - mf->addr);
+    size_t comp_bytes = box_size * fmt.elem_size;
+
+    for (int c = 0; c < job->n_comps; c++) {
+        size_t start = data_start + (size_t)job->vars[c] * comp_bytes;
+        if (start >= mf->length) continue;
+        size_t avail = mf->length - start;
+        if (avail > comp_bytes) avail = comp_bytes;
+        scatter_job_box(job, job->order[n], mf->addr + start, avail, &fmt, c);
+    }
+}
+
+/* I/O worker: claim boxes until none are left. With stdio each worker keeps
+ * its own FILE and staging buffer and reopens only when the file changes. */
+static void *fab_read_worker(void *arg) {
+    FabReadJob *job = (FabReadJob *)arg;
+    char path[MAX_PATH];
+    char line[MAX_LINE];
+    FILE *fp = NULL;
+    const char *open_name = NULL;
+    double *box_data = NULL;
+
+    while (1) {
+        int n = __atomic_fetch_add(&job->next_box, 1, __ATOMIC_RELAXED);
+        if (n >= job->n_boxes) break;
+
+        /* Files that could not be mapped are read with stdio */
+        if (job->backend == IO_BACKEND_MMAP && job->maps[n]) {
+            read_fab_box_mmap(job, n);
+            continue;
+        }
+        if (!box_data) {
+            box_data = (double *)malloc((job->max_box_size > 0 ? job->max_box_size : 1) * sizeof(double));
+            if (!box_data) {
+                __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+
+        const Box *box = &job->boxes[job->order[n]];
+        size_t box_size = (size_t)(box->hi[0] - box->lo[0] + 1) *
+                          (box->hi[1] - box->lo[1] + 1) *
+                          (box->hi[2] - box->lo[2] + 1);
+
+        /* Boxes arrive grouped by file and in offset order */
+        if (!open_name || strcmp(open_name, box->filename) != 0) {
+            if (fp) fclose(fp);
+            snprintf(path, MAX_PATH, "%s/%s", job->level_dir, box->filename);
+            fp = fopen(path, "rb");
+            open_name = box->filename;
+            if (!fp) fprintf(stderr, "Error: Cannot open %s\n", path);
+        }
+
+        /* Parse the FAB header line; components follow back to back, so
+         * ascending components are a forward walk through the box. A box
+         * without a readable header is missing: the load fails. */
+        FabFormat fmt;
+        if (!fp || box->offset < 0 || fseek(fp, box->offset, SEEK_SET) != 0 ||
+            !fgets(line, MAX_LINE, fp)) {
+            __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        parse_fab_header(line, &fmt);
+        long data_start = ftell(fp);
+        size_t comp_bytes = box_size * fmt.elem_size;
+
+        for (int c = 0; c < job->n_comps; c++) {
+            long pos = data_start + (long)(job->vars[c] * comp_bytes);
+            if (ftell(fp) != pos && fseek(fp, pos, SEEK_SET) != 0) break;
+            size_t got = fread(box_data, 1, comp_bytes, fp);
+            scatter_job_box(job, job->order[n], (const char *)box_data, got, &fmt, c);
+            if (got < comp_bytes) break;
+        }
+    }
+
+    if (fp) fclose(fp);
+    free(box_data);
+    return NULL;
+}
+
+/* ========== io_uring Backend ========== */
+
+/* Staging memory the io_uring backend may hold for in-flight reads; the
+ * queue depth shrinks for very large boxes to stay within it */
+#define URING_STAGING_BYTES (256UL * 1024 * 1024)
+
+/* Batch read callbacks: prep fills in the descriptor, length and offset of
+ * read i (or returns -1 to skip it); done receives the bytes read, which
+ * may be short at end of file or on error */
+typedef int (*UringPrepFunc)(void *ctx, int i, int *fd, size_t *len, off_t *off);
+typedef void (*UringDoneFunc)(void *ctx, int i, const char *buf, size_t got);
+
+#ifdef HAVE_IO_URING
+/* One io_uring instance, driven with raw syscalls so no liburing is needed */
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+} IoUring;
+
+/* Ask the kernel whether a ring can run IORING_OP_READV. Kernels older
+ * than the opcode probe (5.6) reject the query, and all of them have
+ * READV. */
+static int uring_supports_readv(int ring_fd) {
+#if defined(__NR_io_uring_register) && defined(IO_URING_OP_SUPPORTED)
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = (struct io_uring_probe *)calloc(1, size);
+    int supported = 1;
+    if (probe && syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0) {
+        supported = probe->last_op >= IORING_OP_READV &&
+                    (probe->ops[IORING_OP_READV].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+#else
+    (void)ring_fd;
+    return 1;
+#endif
+}
+
+/* Create a ring with room for entries submissions.
+ * Returns -1 when the kernel has no io_uring, it is disabled, or it cannot
+ * run vectored reads. */
+static int uring_init(IoUring *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(IoUring));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return -1;
+    if (!uring_supports_readv(ring->fd)) {
+        close(ring->fd);
         return -1;
     }
-    
-    /* Reset grid dimensions for this level */
-    int level_lo[3] = {0, 0, 0};
-    int level_hi[3] = {0, 0, 0};
-    int found_domain = 0;
-    
-    /* Skip first few lines until we find box definitions */
-    int box_count = 0;
-    while (fgets(line, MAX_LINE, fp)) {
-        if (strncmp(line, "((", 2) == 0) {
-            /* Parse box: ((lo_x,lo_y,lo_z) (hi_x,hi_y,hi_z) ...) */
-            char *p = line + 2;
-            int lo[3], hi[3];
-            for (i = 0; i < pf->ndim; i++) {
-                while (*p && !isdigit(*p) && *p != '-') p++;
-                lo[i] = atoi(p);
-                pf->boxes[box_count].lo[i] = lo[i];
-                while (*p && (isdigit(*p) || *p == '-')) p++;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring->fd);
+            return -1;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe *)mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return -1;
+    }
+
+    char *sq = (char *)ring->sq_ring;
+    char *cq = (char *)ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+static void uring_exit(IoUring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+/* One staging buffer and its read in flight */
+typedef struct {
+    int item;
+    int fd;
+    off_t off;
+    size_t len;
+    size_t got;
+    char *buf;
+    struct iovec iov;
+} UringSlot;
+
+/* Queue the remainder of a slot's read */
+static void uring_queue_slot(IoUring *ring, UringSlot *slot, int s) {
+    unsigned tail = *ring->sq_tail;
+    unsigned idx = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+
+    slot->iov.iov_base = slot->buf + slot->got;
+    slot->iov.iov_len = slot->len - slot->got;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = slot->fd;
+    sqe->off = (uint64_t)(slot->off + (off_t)slot->got);
+    sqe->addr = (uint64_t)(uintptr_t)&slot->iov;
+    sqe->len = 1;
+    sqe->user_data = (uint64_t)s;
+    ring->sq_array[idx] = idx;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Run n reads through one ring with at most depth in flight, each into its
+ * own staging buffer of max_len bytes. A read that fails is handed to done
+ * with the bytes it got and counted, as is an item prep refuses. Returns
+ * the number of failed reads, or -1 when io_uring is unavailable (the ring
+ * cannot be set up, or the kernel rejects it before taking any read) so
+ * the caller can fall back. */
+static int uring_read_batch(int n, int depth, size_t max_len,
+                            UringPrepFunc prep, UringDoneFunc done, void *ctx) {
+    if (n <= 0) return 0;
+    if (max_len == 0) max_len = 1;
+    if (depth > n) depth = n;
+    if ((size_t)depth * max_len > URING_STAGING_BYTES) {
+        depth = (int)(URING_STAGING_BYTES / max_len);
+        if (depth < 1) depth = 1;
+    }
+
+    IoUring ring;
+    if (uring_init(&ring, (unsigned)depth) < 0) return -1;
+
+    UringSlot *slots = (UringSlot *)calloc(depth, sizeof(UringSlot));
+    int *free_slots = (int *)malloc(depth * sizeof(int));
+    char *staging = (char *)malloc((size_t)depth * max_len);
+    if (!slots || !free_slots || !staging) {
+        free(slots);
+        free(free_slots);
+        free(staging);
+        uring_exit(&ring);
+        return -1;
+    }
+    for (int s = 0; s < depth; s++) {
+        slots[s].buf = staging + (size_t)s * max_len;
+        free_slots[s] = depth - 1 - s;
+    }
+
+    int n_free = depth;
+    int next = 0;
+    int in_flight = 0;
+    int to_submit = 0;
+    int unsupported = 0;
+    int n_submitted = 0;
+    int n_failed = 0;
+    int abandoned = 0;
+
+    while (in_flight > 0 || (next < n && !unsupported)) {
+        /* Top the ring up to the queue depth */
+        while (n_free > 0 && next < n && !unsupported) {
+            int fd;
+            size_t len;
+            off_t off;
+            int i = next++;
+            if (prep(ctx, i, &fd, &len, &off) < 0 || fd < 0) {
+                n_failed++;
+                continue;
             }
-            for (i = 0; i < pf->ndim; i++) {
-                while (*p && !isdigit(*p) && *p != '-') p++;
-                hi[i] = atoi(p);
-                pf->boxes[box_count].hi[i] = hi[i];
-                while (*p && (isdigit(*p) || *p == '-')) p++;
+            if (len > max_len) len = max_len;
+            if (len == 0) {
+                done(ctx, i, NULL, 0);
+                continue;
             }
-            
-            /* Track overall domain bounds */
-            if (!found_domain) {
-                for (i = 0; i < pf->ndim; i++) {
-                    level_lo[i] = lo[i];
-                    level_hi[i] = hi[i];
-                }
-                found_domain = 1;
+            int s = free_slots[--n_free];
+            slots[s].item = i;
+            slots[s].fd = fd;
+            slots[s].off = off;
+            slots[s].len = len;
+            slots[s].got = 0;
+            uring_queue_slot(&ring, &slots[s], s);
+            to_submit++;
+            in_flight++;
+        }
+        if (in_flight == 0) break;
+
+        int ret = (int)syscall(__NR_io_uring_enter, ring.fd, to_submit, 1,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            /* The kernel rejected the ring. Reads it already took may still
+             * land in the staging buffers, which are then never freed. */
+            if (n_submitted == 0) {
+                unsupported = 1;
             } else {
-                for (i = 0; i < pf->ndim; i++) {
-                    if (lo[i] < level_lo[i]) level_lo[i] = lo[i];
-                    if (hi[i] > level_hi[i]) level_hi[i] = hi[i];
-                }
+                fprintf(stderr, "Error: io_uring_enter failed: %s\n", strerror(errno));
+                n_failed += in_flight + (n - next);
+                abandoned = in_flight > to_submit;
             }
-            
-            box_count++;
-        } else if (strncmp(line, "FabOnDisk:", 10) == 0) {
-            /* Parse FabOnDisk: Cell_D_XXXXX */
-            char *p = strchr(line, ':');
-            if (p) {
-                p++;
-                while (*p == ' ') p++;
-                char *end = strchr(p, ' ');
-                if (end) *end = '\0';
-                end = strchr(p, '\n');
-                if (end) *end = '\0';
-                strncpy(pf->boxes[pf->n_boxes].filename, p, 63);
-                pf->n_boxes++;
+            break;
+        }
+        to_submit -= ret;
+        n_submitted += ret;
+
+        /* Reap completions: finished reads hand their slot back, short reads
+         * queue their remainder */
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            int s = (int)cqe->user_data;
+            int res = cqe->res;
+            UringSlot *slot = &slots[s];
+            head++;
+
+            if (res > 0) slot->got += (size_t)res;
+            if (res > 0 && slot->got < slot->len) {
+                uring_queue_slot(&ring, slot, s);
+                to_submit++;
+                continue;
+            }
+            if (res < 0) {
+                if (n_failed++ == 0) fprintf(stderr, "Error: io_uring read failed: %s\n", strerror(-res));
             }
+            done(ctx, slot->item, slot->buf, slot->got);
+            free_slots[n_free++] = s;
+            in_flight--;
         }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
     }
-    
-    fclose(fp);
 
-    /* Update grid dimensions and level bounds */
-    for (i = 0; i < pf->ndim; i++) {
-        pf->level_lo[i] = level_lo[i];
-        pf->level_hi[i] = level_hi[i];
-        pf->grid_dims[i] = level_hi[i] - level_lo[i] + 1;
+    if (!abandoned) {
+        free(slots);
+        free(staging);
     }
-    /* Initialize any remaining dimensions to 0 for 2D cases */
-    for (i = pf->ndim; i < 3; i++) {
-        pf->level_lo[i] = 0;
-        pf->level_hi[i] = 0;
+    free(free_slots);
+    uring_exit(&ring);
+    return unsupported ? -1 : n_failed;
+}
+#else
+static int uring_read_batch(int n, int depth, size_t max_len,
+                            UringPrepFunc prep, UringDoneFunc done, void *ctx) {
+    (void)n; (void)depth; (void)max_len; (void)prep; (void)done; (void)ctx;
+    return -1;
+}
+#endif
+
+/* True when a ring can be set up here, so io_uring reads will not fall
+ * back to stdio */
+static int uring_available(void) {
+#ifdef HAVE_IO_URING
+    IoUring ring;
+    if (uring_init(&ring, 1) < 0) return 0;
+    uring_exit(&ring);
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+/* Set once the stdio fallback has been reported */
+static int uring_fallback_noted = 0;
+
+/* Per-box state of one io_uring FAB load, in plan order */
+typedef struct {
+    FabReadJob *job;
+    int *fds;                  /* Descriptor of each planned box's Cell_D file */
+    FabFormat *fmts;
+    off_t *data_start;         /* First component byte, -1 until the header is read */
+} UringFabLoad;
+
+static int uring_prep_fab_header(void *ctx, int n, int *fd, size_t *len, off_t *off) {
+    UringFabLoad *load = (UringFabLoad *)ctx;
+    const Box *box = &load->job->boxes[load->job->order[n]];
+    if (box->offset < 0) return -1;
+    *fd = load->fds[n];
+    *len = MAX_LINE - 1;
+    *off = box->offset;
+    return 0;
+}
+
+/* Parse a FAB header line; components follow back to back */
+static void uring_done_fab_header(void *ctx, int n, const char *buf, size_t got) {
+    UringFabLoad *load = (UringFabLoad *)ctx;
+    char line[MAX_LINE];
+    const char *nl = got > 0 ? memchr(buf, '\n', got) : NULL;
+    if (!nl) return;
+    memcpy(line, buf, nl - buf);
+    line[nl - buf] = '\0';
+    parse_fab_header(line, &load->fmts[n]);
+    load->data_start[n] = load->job->boxes[load->job->order[n]].offset + (off_t)(nl + 1 - buf);
+}
+
+/* Read i is component i % n_comps of planned box i / n_comps. A box whose
+ * header was not read or has no newline is refused, so it counts as failed. */
+static int uring_prep_fab_comp(void *ctx, int i, int *fd, size_t *len, off_t *off) {
+    UringFabLoad *load = (UringFabLoad *)ctx;
+    FabReadJob *job = load->job;
+    int n = i / job->n_comps;
+    if (load->data_start[n] < 0) return -1;
+    const Box *box = &job->boxes[job->order[n]];
+    size_t comp_bytes = (size_t)(box->hi[0] - box->lo[0] + 1) *
+                        (box->hi[1] - box->lo[1] + 1) *
+                        (box->hi[2] - box->lo[2] + 1) * load->fmts[n].elem_size;
+    *fd = load->fds[n];
+    *len = comp_bytes;
+    *off = load->data_start[n] + (off_t)((size_t)job->vars[i % job->n_comps] * comp_bytes);
+    return 0;
+}
+
+static void uring_done_fab_comp(void *ctx, int i, const char *buf, size_t got) {
+    UringFabLoad *load = (UringFabLoad *)ctx;
+    FabReadJob *job = load->job;
+    int n = i / job->n_comps;
+    scatter_job_box(job, job->order[n], buf, got, &load->fmts[n], i % job->n_comps);
+}
+
+/* io_uring backend: queue every FAB header, then every box component, with
+ * up to io_depth reads in flight from the calling thread. Failed reads set
+ * job->failed. Returns -1 when io_uring is unavailable (the caller falls
+ * back to stdio). */
+static int read_fab_components_uring(FabReadJob *job) {
+    int n = job->n_boxes;
+    size_t alloc = n > 0 ? n : 1;
+    UringFabLoad load = {job, NULL, NULL, NULL};
+    int result = -1;
+
+    load.fds = (int *)malloc(alloc * sizeof(int));
+    load.fmts = (FabFormat *)calloc(alloc, sizeof(FabFormat));
+    load.data_start = (off_t *)malloc(alloc * sizeof(off_t));
+    if (!load.fds || !load.fmts || !load.data_start) {
+        free(load.fds);
+        free(load.fmts);
+        free(load.data_start);
+        job->failed = 1;
+        return 0;
+    }
+
+    /* Open each Cell_D file once; boxes arrive grouped by file */
+    for (int b = 0; b < n; b++) {
+        const Box *box = &job->boxes[job->order[b]];
+        load.data_start[b] = -1;
+        if (b > 0 && strcmp(box->filename, job->boxes[job->order[b - 1]].filename) == 0) {
+            load.fds[b] = load.fds[b - 1];
+        } else {
+            char path[MAX_PATH];
+            snprintf(path, MAX_PATH, "%s/%s", job->level_dir, box->filename);
+            load.fds[b] = open(path, O_RDONLY);
+            if (load.fds[b] < 0) fprintf(stderr, "Error: Cannot open %s\n", path);
+        }
+    }
+
+    result = uring_read_batch(n, io_depth, MAX_LINE - 1, uring_prep_fab_header,
+                              uring_done_fab_header, &load);
+    if (result >= 0) {
+        size_t max_len = job->max_box_size * sizeof(double);
+        int failed = uring_read_batch(n * job->n_comps, io_depth, max_len, uring_prep_fab_comp,
+                                      uring_done_fab_comp, &load);
+        /* Boxes whose reads failed are missing: the load failed */
+        if (result > 0 || failed > 0) job->failed = 1;
+        result = failed < 0 ? -1 : 0;
+    }
+
+    for (int b = 0; b < n; b++) {
+        if (load.fds[b] >= 0 && (b == 0 || load.fds[b] != load.fds[b - 1])) close(load.fds[b]);
+    }
+    free(load.fds);
+    free(load.fmts);
+    free(load.data_start);
+    return result;
+}
+
+/* Read several components of every box in a level directory in one pass and
+ * scatter each into its own dense (Z, Y, X) array with the given dimensions
+ * and lower index bounds. vars must be ascending. Each dest must be
+ * zero-initialized; cells missing from short files stay zero. With
+ * box_offset each dest instead holds every box's own (Z, Y, X) array back to
+ * back, box b starting at element box_offset[b]. Boxes are
+ * spread over io_threads workers, or queued io_depth at a time through one
+ * io_uring. The mmap backend shares the per-timestep mapping table, so only
+ * the UI thread may use it.
+ * Returns the number of Cell_D files read, or -1 when a box header
+ * cannot be read or on allocation failure. */
+static int read_fab_components_backend(int backend, const char *level_dir,
+                                       const Box *boxes, int n_boxes,
+                                       const int *vars, void **dests, int n_comps,
+                                       const int *dims, const int *lo,
+                                       const size_t *box_offset) {
+    FabReadJob job = {0};
+    int n_files = 0;
+
+    int *order = plan_box_reads(boxes, n_boxes);
+    if (!order) return -1;
+
+    job.level_dir = level_dir;
+    job.boxes = boxes;
+    job.order = order;
+    job.n_boxes = n_boxes;
+    job.vars = vars;
+    job.dests = dests;
+    job.n_comps = n_comps;
+    job.dims = dims;
+    job.lo = lo;
+    job.box_offset = box_offset;
+    job.backend = backend;
+
+    for (int n = 0; n < n_boxes; n++) {
+        const Box *box = &boxes[order[n]];
+        size_t box_size = (size_t)(box->hi[0] - box->lo[0] + 1) *
+                          (box->hi[1] - box->lo[1] + 1) *
+                          (box->hi[2] - box->lo[2] + 1);
+        if (box_size > job.max_box_size) job.max_box_size = box_size;
+        if (n == 0 || strcmp(box->filename, boxes[order[n - 1]].filename) != 0) n_files++;
+    }
+
+    /* Map files up front so the workers only read shared state */
+    if (backend == IO_BACKEND_MMAP) {
+        job.maps = (const MappedFile **)malloc((n_boxes > 0 ? n_boxes : 1) * sizeof(MappedFile *));
+        if (!job.maps) {
+            free(order);
+            return -1;
+        }
+        for (int n = 0; n < n_boxes; n++) {
+            const Box *box = &boxes[order[n]];
+            if (n > 0 && strcmp(box->filename, boxes[order[n - 1]].filename) == 0) {
+                job.maps[n] = job.maps[n - 1];
+            } else {
+                job.maps[n] = map_cell_d_file(level_dir, box->filename);
+            }
+        }
+    }
+
+    /* io_uring queues every read from this thread; without it, use stdio */
+    if (backend == IO_BACKEND_URING) {
+        if (read_fab_components_uring(&job) == 0) {
+            free(order);
+            return job.failed ? -1 : n_files;
+        }
+        if (!__atomic_exchange_n(&uring_fallback_noted, 1, __ATOMIC_RELAXED)) {
+            printf("io_uring unavailable, using the stdio reader\n");
+        }
+        job.backend = IO_BACKEND_STDIO;
+    }
+
+    int n_threads = io_threads;
+    if (n_threads > n_boxes) n_threads = n_boxes;
+    if (n_threads > MAX_IO_THREADS) n_threads = MAX_IO_THREADS;
+
+    if (n_threads <= 1) {
+        fab_read_worker(&job);
+    } else {
+        pthread_t threads[MAX_IO_THREADS];
+        int started = 0;
+        for (int t = 0; t < n_threads - 1; t++) {
+            if (pthread_create(&threads[t], NULL, fab_read_worker, &job) != 0) break;
+            started++;
+        }
+        /* The calling thread drains whatever the workers have not claimed */
+        fab_read_worker(&job);
+        for (int t = 0; t < started; t++) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    free(job.maps);
+    free(order);
+    return job.failed ? -1 : n_files;
+}
+
+/* Read several components with the backend selected by --io */
+int read_fab_components(const char *level_dir, const Box *boxes, int n_boxes,
+                        const int *vars, void **dests, int n_comps,
+                        const int *dims, const int *lo) {
+    return read_fab_components_backend(io_backend, level_dir, boxes, n_boxes,
+                                       vars, dests, n_comps, dims, lo, NULL);
+}
+
+/* Read one component of every box in a level directory into dest */
+int read_fab_component(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                       void *dest, const int *dims, const int *lo) {
+    return read_fab_components(level_dir, boxes, n_boxes, &var_idx, &dest, 1, dims, lo);
+}
+
+/* Read one component of every box into packed per-box storage: box b lands
+ * in its own (Z, Y, X) array at element box_offset[b] of dest */
+int read_fab_component_packed(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                              void *dest, const size_t *box_offset) {
+    return read_fab_components_backend(io_backend, level_dir, boxes, n_boxes,
+                                       &var_idx, &dest, 1, NULL, NULL, box_offset);
+}
+
+/* ========== Cell_H Range Index ========== */
+
+/* Release a range index so it can be refilled */
+void free_range_index(RangeIndex *ri) {
+    free(ri->min);
+    free(ri->max);
+    memset(ri, 0, sizeof(RangeIndex));
+}
+
+/* Read one Cell_H min or max table whose "n,ncomp" line is in line. The
+ * first table holds the minima, the second the maxima; each row is one FAB
+ * with a trailing comma after every component. */
+static int read_range_table(FILE *fp, const char *line, RangeIndex *ri) {
+    int nb, nc;
+    if (sscanf(line, "%d,%d", &nb, &nc) != 2 || nb <= 0 || nc <= 0) return -1;
+
+    if (ri->n_tables == 0) {
+        ri->min = (double *)malloc((size_t)nb * nc * sizeof(double));
+        ri->max = (double *)malloc((size_t)nb * nc * sizeof(double));
+        if (!ri->min || !ri->max) {
+            free_range_index(ri);
+            return -1;
+        }
+        ri->n_boxes = nb;
+        ri->n_comps = nc;
+    } else if (ri->n_tables >= 2 || nb != ri->n_boxes || nc != ri->n_comps) {
+        return -1;
+    }
+
+    double *dst = (ri->n_tables == 0) ? ri->min : ri->max;
+    for (size_t v = 0; v < (size_t)nb * nc; v++) {
+        if (fscanf(fp, "%lf,", &dst[v]) != 1) {
+            free_range_index(ri);
+            return -1;
+        }
+    }
+    ri->n_tables++;
+    return 0;
+}
+
+/* True when both tables were read and match the level's boxes */
+int range_index_valid(const RangeIndex *ri, int n_boxes, int var_idx) {
+    return ri->n_tables == 2 && ri->n_boxes == n_boxes && n_boxes > 0 &&
+           var_idx >= 0 && var_idx < ri->n_comps;
+}
+
+/* Full-volume range of one component from the Cell_H tables alone.
+ * Returns -1 when the level has no usable tables. */
+int range_index_volume(const RangeIndex *ri, int n_boxes, int var_idx, double *vmin, double *vmax) {
+    if (!range_index_valid(ri, n_boxes, var_idx)) return -1;
+    double lo = ri->min[var_idx], hi = ri->max[var_idx];
+    for (int b = 1; b < n_boxes; b++) {
+        size_t v = (size_t)b * ri->n_comps + var_idx;
+        if (ri->min[v] < lo) lo = ri->min[v];
+        if (ri->max[v] > hi) hi = ri->max[v];
+    }
+    *vmin = lo;
+    *vmax = hi;
+    return 0;
+}
+
+/* A box and the width of its Cell_H range for one component */
+typedef struct {
+    double span;
+    int box;
+} BoxSpan;
+
+/* Comparison function for range scans: widest box range first */
+static int compare_box_spans(const void *a, const void *b) {
+    const BoxSpan *sa = (const BoxSpan *)a;
+    const BoxSpan *sb = (const BoxSpan *)b;
+    if (sa->span > sb->span) return -1;
+    if (sa->span < sb->span) return 1;
+    return sa->box - sb->box;
+}
+
+/* Reorder n box indices widest Cell_H range of var_idx first.
+ * Returns -1 on allocation failure, leaving the order as it was. */
+static int sort_boxes_by_span(const RangeIndex *ri, int var_idx, int *order, int n) {
+    BoxSpan *spans = (BoxSpan *)malloc((n > 0 ? n : 1) * sizeof(BoxSpan));
+    if (!spans) return -1;
+    for (int i = 0; i < n; i++) {
+        size_t v = (size_t)order[i] * ri->n_comps + var_idx;
+        spans[i].span = ri->max[v] - ri->min[v];
+        spans[i].box = order[i];
+    }
+    qsort(spans, n, sizeof(BoxSpan), compare_box_spans);
+    for (int i = 0; i < n; i++) order[i] = spans[i].box;
+    free(spans);
+    return 0;
+}
+
+/* Widen [vmin, vmax] by the cells of a slice that lie inside boxes crossing
+ * the plane at slice_coord (level index space). Boxes are visited widest
+ * Cell_H range first; a box whose range already lies inside the running
+ * bounds cannot change them, so its cells are never scanned.
+ * Returns -1, leaving the bounds untouched, when there is no range index. */
+int slice_range_indexed(const double *slice, int width, int height, const Box *boxes, int n_boxes,
+                        const BoxIndex *index, const RangeIndex *ri, int var_idx, int axis,
+                        int slice_coord, const int *level_lo, double *vmin, double *vmax) {
+    if (!range_index_valid(ri, n_boxes, var_idx)) return -1;
+
+    int *order = (int *)malloc(n_boxes * sizeof(int));
+    if (!order) return -1;
+    int n_cross = box_index_plane(index, boxes, axis, slice_coord, order);
+    if (sort_boxes_by_span(ri, var_idx, order, n_cross) < 0) {
+        free(order);
+        return -1;
+    }
+
+    int dim_x = (axis == 0) ? 1 : 0;
+    int dim_y = (axis == 2) ? 1 : 2;
+    double lo = *vmin, hi = *vmax;
+    for (int n = 0; n < n_cross; n++) {
+        const Box *box = &boxes[order[n]];
+        size_t v = (size_t)order[n] * ri->n_comps + var_idx;
+        if (ri->min[v] >= lo && ri->max[v] <= hi) continue;
+
+        int mi_lo = box->lo[dim_x] - level_lo[dim_x];
+        int mi_hi = box->hi[dim_x] - level_lo[dim_x];
+        int mj_lo = box->lo[dim_y] - level_lo[dim_y];
+        int mj_hi = box->hi[dim_y] - level_lo[dim_y];
+        if (mi_lo < 0) mi_lo = 0;
+        if (mj_lo < 0) mj_lo = 0;
+        if (mi_hi >= width) mi_hi = width - 1;
+        if (mj_hi >= height) mj_hi = height - 1;
+        for (int mj = mj_lo; mj <= mj_hi; mj++) {
+            const double *row = &slice[(size_t)mj * width];
+            for (int mi = mi_lo; mi <= mi_hi; mi++) {
+                if (row[mi] < lo) lo = row[mi];
+                if (row[mi] > hi) hi = row[mi];
+            }
+        }
+    }
+    free(order);
+    *vmin = lo;
+    *vmax = hi;
+    return 0;
+}
+
+/* Widen [vmin, vmax] by the cells of a packed level on the plane at coord
+ * (level index space), one crossing box at a time. With Cell_H range tables
+ * boxes are visited widest range first and boxes that cannot widen the
+ * bounds are skipped. Returns -1 on allocation failure. */
+int level_slice_range(const LevelData *ld, int var_idx, int axis, int coord,
+                      double *vmin, double *vmax) {
+    int *order = (int *)malloc((ld->n_boxes > 0 ? ld->n_boxes : 1) * sizeof(int));
+    if (!order) return -1;
+    int n_cross = box_index_plane(&ld->box_index, ld->boxes, axis, coord, order);
+
+    const RangeIndex *ri = &ld->ranges;
+    int indexed = range_index_valid(ri, ld->n_boxes, var_idx);
+    if (indexed && sort_boxes_by_span(ri, var_idx, order, n_cross) < 0) {
+        free(order);
+        return -1;
+    }
+
+    /* One patch buffer sized for the largest crossing box */
+    size_t max_area = 1;
+    for (int n = 0; n < n_cross; n++) {
+        int pw, ph;
+        box_plane_dims(&ld->boxes[order[n]], axis, &pw, &ph);
+        if ((size_t)pw * ph > max_area) max_area = (size_t)pw * ph;
+    }
+    double *patch = (double *)malloc(max_area * sizeof(double));
+    if (!patch) {
+        free(order);
+        return -1;
+    }
+
+    double lo = *vmin, hi = *vmax;
+    for (int n = 0; n < n_cross; n++) {
+        if (indexed) {
+            size_t v = (size_t)order[n] * ri->n_comps + var_idx;
+            if (ri->min[v] >= lo && ri->max[v] <= hi) continue;
+        }
+        int pw, ph;
+        box_plane_dims(&ld->boxes[order[n]], axis, &pw, &ph);
+        extract_level_box_plane(ld, order[n], axis, coord, patch);
+        for (size_t c = 0; c < (size_t)pw * ph; c++) {
+            if (patch[c] < lo) lo = patch[c];
+            if (patch[c] > hi) hi = patch[c];
+        }
+    }
+    free(patch);
+    free(order);
+    *vmin = lo;
+    *vmax = hi;
+    return 0;
+}
+
+/* Range of a variable over the whole current level, and over the finer
+ * overlay levels when overlay mode is on, from Cell_H tables only.
+ * Returns -1 when the current level has no range index. */
+int variable_global_range(PlotfileData *pf, int var_idx, double *vmin, double *vmax) {
+    if (range_index_volume(&pf->ranges, pf->n_boxes, var_idx, vmin, vmax) < 0) return -1;
+    if (pf->overlay_mode && pf->n_levels > 1) {
+        for (int level = pf->current_level + 1; level < pf->n_levels && level < MAX_LEVELS; level++) {
+            LevelData *ld = &pf->levels[level];
+            double lo, hi;
+            if (!ld->loaded || range_index_volume(&ld->ranges, ld->n_boxes, var_idx, &lo, &hi) < 0) continue;
+            if (lo < *vmin) *vmin = lo;
+            if (hi > *vmax) *vmax = hi;
+        }
+    }
+    return 0;
+}
+
+/* ========== Box Spatial Index ========== */
+
+/* Comparison functions for BVH splits: order Box pointers by center on
+ * one axis. One per axis keeps the sort free of shared state, as indexes
+ * are built on the prefetch thread too. */
+#define DEFINE_COMPARE_BOX_CENTERS(name, axis)                          \
+static int name(const void *a, const void *b) {                         \
+    const Box *ba = *(const Box *const *)a;                             \
+    const Box *bb = *(const Box *const *)b;                             \
+    int ca = ba->lo[axis] + ba->hi[axis];                               \
+    int cb = bb->lo[axis] + bb->hi[axis];                               \
+    return (ca > cb) - (ca < cb);                                       \
+}
+
+DEFINE_COMPARE_BOX_CENTERS(compare_box_centers_x, 0)
+DEFINE_COMPARE_BOX_CENTERS(compare_box_centers_y, 1)
+DEFINE_COMPARE_BOX_CENTERS(compare_box_centers_z, 2)
+
+static int (*const compare_box_centers[3])(const void *, const void *) = {
+    compare_box_centers_x, compare_box_centers_y, compare_box_centers_z
+};
+
+/* Build the subtree over order[start .. start+count-1], splitting at the
+ * median box center along the longest axis. sorted is scratch for count
+ * Box pointers. Returns the node index. */
+static int build_box_node(BoxIndex *bi, const Box *boxes, const Box **sorted, int start, int count) {
+    int id = bi->n_nodes++;
+    BoxNode *node = &bi->nodes[id];
+
+    for (int d = 0; d < 3; d++) {
+        node->lo[d] = boxes[bi->order[start]].lo[d];
+        node->hi[d] = boxes[bi->order[start]].hi[d];
+    }
+    for (int n = start + 1; n < start + count; n++) {
+        const Box *box = &boxes[bi->order[n]];
+        for (int d = 0; d < 3; d++) {
+            if (box->lo[d] < node->lo[d]) node->lo[d] = box->lo[d];
+            if (box->hi[d] > node->hi[d]) node->hi[d] = box->hi[d];
+        }
+    }
+
+    node->start = start;
+    node->count = count;
+    if (count <= BOX_LEAF_SIZE) return id;
+
+    int axis = 0;
+    for (int d = 1; d < 3; d++) {
+        if (node->hi[d] - node->lo[d] > node->hi[axis] - node->lo[axis]) axis = d;
+    }
+    for (int n = 0; n < count; n++) sorted[n] = &boxes[bi->order[start + n]];
+    qsort(sorted, count, sizeof(Box *), compare_box_centers[axis]);
+    for (int n = 0; n < count; n++) bi->order[start + n] = (int)(sorted[n] - boxes);
+
+    int half = count / 2;
+    node->count = 0;
+    int left = build_box_node(bi, boxes, sorted, start, half);
+    int right = build_box_node(bi, boxes, sorted, start + half, count - half);
+    bi->nodes[id].left = left;
+    bi->nodes[id].right = right;
+    return id;
+}
+
+/* Release a box index so it can be rebuilt */
+void free_box_index(BoxIndex *bi) {
+    free(bi->nodes);
+    free(bi->order);
+    memset(bi, 0, sizeof(BoxIndex));
+}
+
+/* Index a level's boxes. Returns -1 (empty index) on allocation failure. */
+int build_box_index(BoxIndex *bi, const Box *boxes, int n_boxes) {
+    free_box_index(bi);
+    if (n_boxes <= 0) return 0;
+
+    bi->nodes = (BoxNode *)malloc((size_t)2 * n_boxes * sizeof(BoxNode));
+    bi->order = (int *)malloc(n_boxes * sizeof(int));
+    const Box **sorted = (const Box **)malloc(n_boxes * sizeof(Box *));
+    if (!bi->nodes || !bi->order || !sorted) {
+        free(sorted);
+        free_box_index(bi);
+        return -1;
+    }
+    for (int b = 0; b < n_boxes; b++) bi->order[b] = b;
+    build_box_node(bi, boxes, sorted, 0, n_boxes);
+    free(sorted);
+    return 0;
+}
+
+/* Boxes crossing the plane at coord (level index space) on axis. Writes
+ * their indices to hits, which must hold every box; returns the count. */
+int box_index_plane(const BoxIndex *bi, const Box *boxes, int axis, int coord, int *hits) {
+    int stack[64];
+    int sp = 0, n_hits = 0;
+
+    if (bi->n_nodes > 0) stack[sp++] = 0;
+    while (sp > 0) {
+        const BoxNode *node = &bi->nodes[stack[--sp]];
+        if (coord < node->lo[axis] || coord > node->hi[axis]) continue;
+        if (node->count > 0) {
+            for (int n = node->start; n < node->start + node->count; n++) {
+                const Box *box = &boxes[bi->order[n]];
+                if (coord >= box->lo[axis] && coord <= box->hi[axis]) hits[n_hits++] = bi->order[n];
+            }
+        } else {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+    }
+    return n_hits;
+}
+
+/* Box containing a cell (level index space), or -1 if it lies in a gap */
+int box_index_find(const BoxIndex *bi, const Box *boxes, const int *cell) {
+    int stack[64];
+    int sp = 0;
+
+    if (bi->n_nodes > 0) stack[sp++] = 0;
+    while (sp > 0) {
+        const BoxNode *node = &bi->nodes[stack[--sp]];
+        int inside = 1;
+        for (int d = 0; d < 3; d++) {
+            if (cell[d] < node->lo[d] || cell[d] > node->hi[d]) inside = 0;
+        }
+        if (!inside) continue;
+        if (node->count > 0) {
+            for (int n = node->start; n < node->start + node->count; n++) {
+                const Box *box = &boxes[bi->order[n]];
+                if (cell[0] >= box->lo[0] && cell[0] <= box->hi[0] &&
+                    cell[1] >= box->lo[1] && cell[1] <= box->hi[1] &&
+                    cell[2] >= box->lo[2] && cell[2] <= box->hi[2]) return bi->order[n];
+            }
+        } else {
+            stack[sp++] = node->left;
+            stack[sp++] = node->right;
+        }
+    }
+    return -1;
+}
+
+/* Mark the cells of a width x height slice covered by the given boxes
+ * (hits from box_index_plane for the same axis) */
+void box_slice_mask(unsigned char *mask, int width, int height, const Box *boxes,
+                    const int *hits, int n_hits, int axis, const int *level_lo) {
+    int dim_x = (axis == 0) ? 1 : 0;
+    int dim_y = (axis == 2) ? 1 : 2;
+    for (int h = 0; h < n_hits; h++) {
+        const Box *box = &boxes[hits[h]];
+        int mi_lo = box->lo[dim_x] - level_lo[dim_x];
+        int mi_hi = box->hi[dim_x] - level_lo[dim_x];
+        int mj_lo = box->lo[dim_y] - level_lo[dim_y];
+        int mj_hi = box->hi[dim_y] - level_lo[dim_y];
+        if (mi_lo < 0) mi_lo = 0;
+        if (mj_lo < 0) mj_lo = 0;
+        if (mi_hi >= width) mi_hi = width - 1;
+        if (mj_hi >= height) mj_hi = height - 1;
+        for (int mj = mj_lo; mj <= mj_hi; mj++) {
+            if (mi_hi >= mi_lo) memset(&mask[(size_t)mj * width + mi_lo], 1, mi_hi - mi_lo + 1);
+        }
+    }
+}
+
+/* Make room for at least n boxes in a growable box list. New entries are
+ * zeroed so unused dimensions of 2D boxes read as 0. */
+int reserve_boxes(Box **boxes, int *capacity, int n) {
+    if (n <= *capacity) return 0;
+    int cap = *capacity > 0 ? *capacity : 64;
+    while (cap < n) cap *= 2;
+
+    Box *grown = (Box *)realloc(*boxes, (size_t)cap * sizeof(Box));
+    if (!grown) return -1;
+    memset(grown + *capacity, 0, (size_t)(cap - *capacity) * sizeof(Box));
+    *boxes = grown;
+    *capacity = cap;
+    return 0;
+}
+
+/* Release the Header and Cell_H metadata owned by a PlotfileData */
+void free_plotfile_metadata(PlotfileData *pf) {
+    free(pf->variables);
+    pf->variables = NULL;
+    pf->n_vars = 0;
+    free(pf->boxes);
+    pf->boxes = NULL;
+    pf->n_boxes = 0;
+    pf->box_capacity = 0;
+    free_range_index(&pf->ranges);
+    free_box_index(&pf->box_index);
+}
+
+/* Parse a Cell_H file: box definitions, FabOnDisk entries and the trailing
+ * per-FAB min/max tables. The box list and range index are refilled. */
+int parse_cell_h(const char *path, int ndim, Box **boxes, int *capacity, int *n_boxes,
+                 RangeIndex *ri) {
+    char line[MAX_LINE];
+    FILE *fp;
+    int i;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open %s\n", path);
+        return -1;
+    }
+
+    *n_boxes = 0;
+    free_range_index(ri);
+
+    int box_count = 0;
+    while (fgets(line, MAX_LINE, fp)) {
+        if (line[0] == '(' && isdigit((unsigned char)line[1])) {
+            /* Box array header "(n_boxes 0": size the box list up front */
+            int n = atoi(line + 1);
+            if (reserve_boxes(boxes, capacity, n) < 0) {
+                fprintf(stderr, "Error: Cannot allocate %d boxes\n", n);
+                fclose(fp);
+                return -1;
+            }
+        } else if (strncmp(line, "((", 2) == 0) {
+            /* Parse box: ((lo_x,lo_y,lo_z) (hi_x,hi_y,hi_z) ...) */
+            char *p = line + 2;
+            if (reserve_boxes(boxes, capacity, box_count + 1) < 0) {
+                fprintf(stderr, "Error: Cannot allocate boxes\n");
+                fclose(fp);
+                return -1;
+            }
+            Box *box = &(*boxes)[box_count];
+            for (i = 0; i < ndim; i++) {
+                while (*p && !isdigit(*p) && *p != '-') p++;
+                box->lo[i] = atoi(p);
+                while (*p && (isdigit(*p) || *p == '-')) p++;
+            }
+            for (i = 0; i < ndim; i++) {
+                while (*p && !isdigit(*p) && *p != '-') p++;
+                box->hi[i] = atoi(p);
+                while (*p && (isdigit(*p) || *p == '-')) p++;
+            }
+            box_count++;
+        } else if (strncmp(line, "FabOnDisk:", 10) == 0) {
+            /* Parse FabOnDisk: Cell_D_XXXXX <offset> */
+            if (reserve_boxes(boxes, capacity, *n_boxes + 1) == 0 &&
+                parse_fab_on_disk(line, &(*boxes)[*n_boxes]) == 0) {
+                (*n_boxes)++;
+            }
+        } else if (*n_boxes > 0 && strchr(line, ',')) {
+            /* Trailing per-FAB min/max tables */
+            read_range_table(fp, line, ri);
+        }
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/* Index bounds covering every box of a level */
+void box_bounds(const Box *boxes, int n_boxes, int ndim, int *lo, int *hi) {
+    for (int b = 0; b < n_boxes; b++) {
+        for (int i = 0; i < ndim; i++) {
+            if (b == 0 || boxes[b].lo[i] < lo[i]) lo[i] = boxes[b].lo[i];
+            if (b == 0 || boxes[b].hi[i] > hi[i]) hi[i] = boxes[b].hi[i];
+        }
+    }
+}
+
+/* Read Cell_H to get box layout and FabOnDisk mapping */
+int read_cell_h(PlotfileData *pf) {
+    char path[MAX_PATH];
+    int i;
+
+    /* Reset grid dimensions and range index for this level */
+    int level_lo[3] = {0, 0, 0};
+    int level_hi[3] = {0, 0, 0};
+
+    /* Box layout from the run index, or parsed and then indexed */
+    if (run_index_load_level(pf->plotfile_dir, pf->current_level, &pf->boxes,
+                             &pf->box_capacity, &pf->n_boxes, &pf->ranges) < 0) {
+        snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", pf->plotfile_dir, pf->current_level);
+        if (parse_cell_h(path, pf->ndim, &pf->boxes, &pf->box_capacity, &pf->n_boxes,
+                         &pf->ranges) < 0) {
+            return -1;
+        }
+        run_index_store_level(pf->plotfile_dir, pf->current_level, pf->boxes, pf->n_boxes,
+                              &pf->ranges);
+    }
+    box_bounds(pf->boxes, pf->n_boxes, pf->ndim, level_lo, level_hi);
+
+    /* Update grid dimensions and level bounds */
+    for (i = 0; i < pf->ndim; i++) {
+        pf->level_lo[i] = level_lo[i];
+        pf->level_hi[i] = level_hi[i];
+        pf->grid_dims[i] = level_hi[i] - level_lo[i] + 1;
+    }
+    /* Initialize any remaining dimensions to 0 for 2D cases */
+    for (i = pf->ndim; i < 3; i++) {
+        pf->level_lo[i] = 0;
+        pf->level_hi[i] = 0;
+    }
+
+    build_box_index(&pf->box_index, pf->boxes, pf->n_boxes);
+
+    printf("Level %d: Found %d boxes, Grid: %d x %d x %d (lo: %d,%d,%d)\n",
+           pf->current_level, pf->n_boxes,
+           pf->grid_dims[0], pf->grid_dims[1], pf->grid_dims[2],
+           pf->level_lo[0], pf->level_lo[1], pf->level_lo[2]);
+    return 0;
+}
+
+/* ========== Field Cache ========== */
+
+/* Find a cached field; on a hit it is pinned until field_cache_release */
+void *field_cache_acquire(const char *dir, int level, int var_idx) {
+    for (int e = 0; e < n_field_cache; e++) {
+        FieldCacheEntry *fe = &field_cache[e];
+        if (fe->level == level && fe->var == var_idx && strcmp(fe->dir, dir) == 0) {
+            fe->refs++;
+            fe->last_used = ++field_cache_clock;
+            field_cache_hits++;
+            return fe->data;
+        }
+    }
+    field_cache_misses++;
+    return NULL;
+}
+
+/* Evict the least recently used unpinned field. Returns -1 if all are pinned. */
+static int field_cache_evict_lru(void) {
+    int victim = -1;
+    for (int e = 0; e < n_field_cache; e++) {
+        if (field_cache[e].refs > 0) continue;
+        if (victim < 0 || field_cache[e].last_used < field_cache[victim].last_used) victim = e;
+    }
+    if (victim < 0) return -1;
+
+    if (field_cache[victim].data == xtile.data) xtile_free();
+    free(field_cache[victim].data);
+    field_cache_bytes -= field_cache[victim].bytes;
+    field_cache[victim] = field_cache[--n_field_cache];
+    return 0;
+}
+
+/* Evict unpinned fields until the cache and the X tile are within
+ * --cache-mb */
+static void field_cache_trim(void) {
+    while (field_cache_bytes + xtile.bytes > (size_t)cache_mb * 1024 * 1024) {
+        if (field_cache_evict_lru() < 0) return;  /* Everything left is in use */
+    }
+}
+
+/* Hand a freshly read field to the cache, pinned for the caller. Fields that
+ * do not fit stay owned by the caller and are freed on release. */
+void field_cache_insert(const char *dir, int level, int var_idx, void *data, size_t bytes) {
+    if (bytes > (size_t)cache_mb * 1024 * 1024) return;
+    if (n_field_cache >= MAX_CACHE_ENTRIES && field_cache_evict_lru() < 0) return;
+
+    FieldCacheEntry *fe = &field_cache[n_field_cache++];
+    strncpy(fe->dir, dir, MAX_PATH - 1);
+    fe->dir[MAX_PATH - 1] = '\0';
+    fe->level = level;
+    fe->var = var_idx;
+    fe->data = data;
+    fe->bytes = bytes;
+    fe->refs = 1;
+    fe->last_used = ++field_cache_clock;
+    field_cache_bytes += bytes;
+    field_cache_trim();
+}
+
+/* Unpin a field from field_cache_acquire/insert, or free it if uncached */
+void field_cache_release(void *data) {
+    if (!data) return;
+    if (data == xtile.data) xtile_free();  /* The view is leaving this field */
+    for (int e = 0; e < n_field_cache; e++) {
+        if (field_cache[e].data == data) {
+            if (field_cache[e].refs > 0) field_cache[e].refs--;
+            field_cache_trim();
+            return;
+        }
+    }
+    free(data);
+}
+
+/* True if a field is cached; does not pin it or count a hit */
+int field_cache_contains(const char *dir, int level, int var_idx) {
+    for (int e = 0; e < n_field_cache; e++) {
+        if (field_cache[e].level == level && field_cache[e].var == var_idx &&
+            strcmp(field_cache[e].dir, dir) == 0) return 1;
+    }
+    return 0;
+}
+
+/* ========== Timestep Prefetch ========== */
+
+/* Background thread: read the current variable of upcoming timesteps into
+ * prefetch slots. Slots are handed to the UI thread, which moves finished
+ * fields into the field cache (the cache itself is UI-thread only). */
+static void *prefetch_worker(void *arg) {
+    PlotfileData *tmp = (PlotfileData *)calloc(1, sizeof(PlotfileData));
+    if (!tmp) return NULL;
+
+    pthread_mutex_lock(&prefetch_lock);
+    while (1) {
+        int s;
+        for (s = 0; s < MAX_PREFETCH_SLOTS; s++) {
+            if (prefetch_slots[s].state == PREFETCH_QUEUED) break;
+        }
+        if (s == MAX_PREFETCH_SLOTS) {
+            pthread_cond_wait(&prefetch_cond, &prefetch_lock);
+            continue;
+        }
+
+        PrefetchSlot *slot = &prefetch_slots[s];
+        slot->state = PREFETCH_LOADING;
+        int level = slot->level;
+        int var_idx = slot->var;
+        free_plotfile_metadata(tmp);
+        memset(tmp, 0, sizeof(PlotfileData));
+        strncpy(tmp->plotfile_dir, slot->dir, MAX_PATH - 1);
+        pthread_mutex_unlock(&prefetch_lock);
+
+        /* Layout of this timestep; skip it if the level or variable is absent */
+        size_t bytes = 0;
+        if (read_header(tmp) == 0 && level < tmp->n_levels && var_idx < tmp->n_vars) {
+            tmp->current_level = level;
+            if (read_cell_h(tmp) == 0) {
+                bytes = (size_t)tmp->grid_dims[0] * tmp->grid_dims[1] *
+                        tmp->grid_dims[2] * FIELD_ELEM_SIZE;
+            }
+        }
+
+        /* Stay within the --prefetch-mb budget for fields not yet adopted */
+        pthread_mutex_lock(&prefetch_lock);
+        int fits = bytes > 0 && prefetch_bytes + bytes <= (size_t)prefetch_mb * 1024 * 1024;
+        if (fits) prefetch_bytes += bytes;
+        pthread_mutex_unlock(&prefetch_lock);
+
+        void *data = NULL;
+        if (fits) {
+            char level_dir[MAX_PATH];
+            if (level_dir_path(level_dir, tmp->plotfile_dir, level) == 0) {
+                data = calloc(bytes / FIELD_ELEM_SIZE, FIELD_ELEM_SIZE);
+            }
+            /* The mmap table is UI-thread only; each io_uring load has its own ring */
+            int backend = io_backend == IO_BACKEND_URING ? IO_BACKEND_URING : IO_BACKEND_STDIO;
+            if (data && read_fab_components_backend(backend, level_dir,
+                                                    tmp->boxes, tmp->n_boxes, &var_idx, &data, 1,
+                                                    tmp->grid_dims, tmp->level_lo, NULL) < 0) {
+                free(data);
+                data = NULL;
+            }
+        }
+
+        pthread_mutex_lock(&prefetch_lock);
+        if (data) {
+            slot->data = data;
+            slot->bytes = bytes;
+            slot->state = PREFETCH_DONE;
+            printf("Prefetched %s: %s\n", slot->dir, tmp->variables[var_idx]);
+        } else {
+            if (fits) prefetch_bytes -= bytes;
+            slot->state = PREFETCH_FREE;
+        }
+        pthread_cond_broadcast(&prefetch_cond);
+    }
+    return NULL;
+}
+
+/* Move finished prefetches into the field cache (UI thread) */
+void prefetch_adopt(void) {
+    pthread_mutex_lock(&prefetch_lock);
+    for (int s = 0; s < MAX_PREFETCH_SLOTS; s++) {
+        PrefetchSlot *slot = &prefetch_slots[s];
+        if (slot->state != PREFETCH_DONE) continue;
+        field_cache_insert(slot->dir, slot->level, slot->var, slot->data, slot->bytes);
+        field_cache_release(slot->data);  /* Unpin; frees it if it did not fit */
+        prefetch_bytes -= slot->bytes;
+        slot->data = NULL;
+        slot->state = PREFETCH_FREE;
+    }
+    pthread_mutex_unlock(&prefetch_lock);
+}
+
+/* Before reading a field on the UI thread: wait for a prefetch of it that is
+ * already in flight, cancel one that has not started, then adopt results */
+void prefetch_wait(const char *dir, int level, int var_idx) {
+    if (!prefetch_started) return;
+    pthread_mutex_lock(&prefetch_lock);
+    for (int s = 0; s < MAX_PREFETCH_SLOTS; s++) {
+        PrefetchSlot *slot = &prefetch_slots[s];
+        if (slot->state == PREFETCH_FREE || slot->level != level ||
+            slot->var != var_idx || strcmp(slot->dir, dir) != 0) continue;
+        if (slot->state == PREFETCH_QUEUED) {
+            slot->state = PREFETCH_FREE;
+        }
+        while (slot->state == PREFETCH_LOADING) {
+            pthread_cond_wait(&prefetch_cond, &prefetch_lock);
+        }
+    }
+    pthread_mutex_unlock(&prefetch_lock);
+    prefetch_adopt();
+}
+
+/* Queue the current variable of the next timesteps in the stepping
+ * direction (up to --prefetch depth) plus the one just behind */
+void schedule_prefetch(PlotfileData *pf) {
+    int targets[MAX_PREFETCH_SLOTS];
+    int n_targets = 0;
+
+    if (prefetch_depth <= 0 || n_timesteps <= 1 || slice_mode ||
+        slice_cache_covers(pf, pf->current_var)) return;
+
+    if (!prefetch_started) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, prefetch_worker, NULL) != 0) {
+            prefetch_depth = 0;
+            return;
+        }
+        pthread_detach(thread);
+        prefetch_started = 1;
+    }
+    prefetch_adopt();
+
+    for (int d = 1; d <= prefetch_depth + 1 && n_targets < MAX_PREFETCH_SLOTS; d++) {
+        int step = (d <= prefetch_depth) ? step_direction * d : -step_direction;
+        int t = ((current_timestep + step) % n_timesteps + n_timesteps) % n_timesteps;
+        int dup = (t == current_timestep);
+        for (int i = 0; i < n_targets; i++) {
+            if (targets[i] == t) dup = 1;
+        }
+        if (!dup) targets[n_targets++] = t;
+    }
+
+    pthread_mutex_lock(&prefetch_lock);
+
+    /* Drop queued work that is no longer wanted */
+    for (int s = 0; s < MAX_PREFETCH_SLOTS; s++) {
+        PrefetchSlot *slot = &prefetch_slots[s];
+        if (slot->state != PREFETCH_QUEUED) continue;
+        int wanted = 0;
+        for (int i = 0; i < n_targets; i++) {
+            if (strcmp(slot->dir, timestep_paths[targets[i]]) == 0 &&
+                slot->level == pf->current_level && slot->var == pf->current_var) wanted = 1;
+        }
+        if (!wanted) slot->state = PREFETCH_FREE;
+    }
+
+    for (int i = 0; i < n_targets; i++) {
+        const char *dir = timestep_paths[targets[i]];
+        if (field_cache_contains(dir, pf->current_level, pf->current_var)) continue;
+
+        int have = 0, free_slot = -1;
+        for (int s = 0; s < MAX_PREFETCH_SLOTS; s++) {
+            PrefetchSlot *slot = &prefetch_slots[s];
+            if (slot->state == PREFETCH_FREE) {
+                if (free_slot < 0) free_slot = s;
+            } else if (slot->level == pf->current_level && slot->var == pf->current_var &&
+                       strcmp(slot->dir, dir) == 0) {
+                have = 1;
+            }
+        }
+        if (have || free_slot < 0) continue;
+
+        PrefetchSlot *slot = &prefetch_slots[free_slot];
+        strncpy(slot->dir, dir, MAX_PATH - 1);
+        slot->dir[MAX_PATH - 1] = '\0';
+        slot->level = pf->current_level;
+        slot->var = pf->current_var;
+        slot->state = PREFETCH_QUEUED;
+    }
+
+    pthread_cond_broadcast(&prefetch_cond);
+    pthread_mutex_unlock(&prefetch_lock);
+}
+
+/* Read variable data from all boxes */
+int read_variable_data(PlotfileData *pf, int var_idx) {
+    char level_dir[MAX_PATH];
+    size_t total_size = (size_t)pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2];
+
+    /* Serve from the field cache when this field was read before */
+    void *cached = field_cache_acquire(pf->plotfile_dir, pf->current_level, var_idx);
+    field_cache_release(pf->data);
+    pf->data = cached;
+    if (pf->data) {
+        printf("Cached variable: %s (cache: %lu hits, %lu misses, %.0f of %d MB)\n",
+               pf->variables[var_idx], field_cache_hits, field_cache_misses,
+               field_cache_bytes / (1024.0 * 1024.0), cache_mb);
+        return 0;
+    }
+
+    if (level_dir_path(level_dir, pf->plotfile_dir, pf->current_level) < 0) return -1;
+
+    /* Allocate data array (Z, Y, X ordering) */
+    pf->data = calloc(total_size, FIELD_ELEM_SIZE);
+    if (!pf->data) {
+        fprintf(stderr, "Error: Cannot allocate memory for %s\n", pf->variables[var_idx]);
+        return -1;
+    }
+
+    /* Read each box, one forward pass per Cell_D file */
+    double t0 = wall_seconds();
+    int n_files = read_fab_component(level_dir, pf->boxes, pf->n_boxes, var_idx,
+                                     pf->data, pf->grid_dims, pf->level_lo);
+    double dt = wall_seconds() - t0;
+    double mb = fab_component_mb(pf->boxes, pf->n_boxes);
+    if (n_files < 0) {
+        /* A partly read field is never shown or cached */
+        fprintf(stderr, "Error: Cannot read %s from %s\n", pf->variables[var_idx], level_dir);
+        free(pf->data);
+        pf->data = NULL;
+        return -1;
+    }
+    if (!sweep_mode) {
+        field_cache_insert(pf->plotfile_dir, pf->current_level, var_idx,
+                           pf->data, total_size * FIELD_ELEM_SIZE);
+    }
+
+    printf("Loaded variable: %s (%d boxes from %d files, %.1f MB in %.3f s, %.1f MB/s)\n",
+           pf->variables[var_idx], pf->n_boxes, n_files, mb, dt, dt > 0 ? mb / dt : 0.0);
+    return 0;
+}
+
+/* Read one plane (axis, idx relative to lo) of one component into a 2D
+ * array laid out as extract_slice does. Only boxes crossing the plane are
+ * touched, and only the bytes they need are fetched with pread: Z planes
+ * are one contiguous read per box, Y planes one X row per box layer. X
+ * planes have a one-cell stride on disk, so each crossing box component is
+ * read whole and the column picked out of it.
+ * Returns the number of boxes read, or -1 when a crossing box cannot be
+ * read or on allocation failure. */
+int read_fab_plane(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                   int axis, int idx, double *plane, const int *dims, const int *lo) {
+    char path[MAX_PATH];
+    char line[MAX_LINE];
+    int g = idx + lo[axis];  /* Plane position in level index space */
+    int pw = (axis == 0) ? dims[1] : dims[0];
+    int ph = (axis == 2) ? dims[1] : dims[2];
+    size_t max_box_size = 0;
+    int n_read = 0;
+    int failed = 0;
+
+    memset(plane, 0, (size_t)pw * ph * sizeof(double));
+
+    for (int b = 0; b < n_boxes; b++) {
+        size_t box_size = (size_t)(boxes[b].hi[0] - boxes[b].lo[0] + 1) *
+                          (boxes[b].hi[1] - boxes[b].lo[1] + 1) *
+                          (boxes[b].hi[2] - boxes[b].lo[2] + 1);
+        if (box_size > max_box_size) max_box_size = box_size;
+    }
+
+    /* Raw bytes of one box component, sized for the widest real format */
+    int *order = plan_box_reads(boxes, n_boxes);
+    char *buf = (char *)malloc((max_box_size > 0 ? max_box_size : 1) * sizeof(double));
+    if (!order || !buf) {
+        free(order);
+        free(buf);
+        return -1;
+    }
+
+    int fd = -1;
+    const char *open_name = NULL;
+
+    for (int n = 0; n < n_boxes; n++) {
+        const Box *box = &boxes[order[n]];
+        if (g < box->lo[axis] || g > box->hi[axis]) continue;
+
+        if (!open_name || strcmp(open_name, box->filename) != 0) {
+            if (fd >= 0) close(fd);
+            snprintf(path, MAX_PATH, "%s/%s", level_dir, box->filename);
+            fd = open(path, O_RDONLY);
+            open_name = box->filename;
+            if (fd < 0) fprintf(stderr, "Error: Cannot open %s\n", path);
+        }
+        if (fd < 0) {
+            failed = 1;
+            break;
+        }
+
+        /* Locate the component: FAB header line, then earlier components */
+        FabFormat fmt;
+        ssize_t hdr = pread(fd, line, MAX_LINE - 1, box->offset);
+        char *nl = hdr > 0 ? memchr(line, '\n', hdr) : NULL;
+        if (!nl) {
+            failed = 1;
+            break;
+        }
+        *nl = '\0';
+        parse_fab_header(line, &fmt);
+
+        int bnx = box->hi[0] - box->lo[0] + 1;
+        int bny = box->hi[1] - box->lo[1] + 1;
+        int bnz = box->hi[2] - box->lo[2] + 1;
+        size_t es = fmt.elem_size;
+        size_t box_size = (size_t)bnx * bny * bnz;
+        off_t comp = box->offset + (nl + 1 - line) + (off_t)var_idx * box_size * es;
+        int l = g - box->lo[axis];
+
+        if (axis == 2) {
+            /* Z plane: bnx * bny contiguous values */
+            size_t count = (size_t)bnx * bny;
+            ssize_t got = pread(fd, buf, count * es, comp + (off_t)l * count * es);
+            if (got <= 0) {
+                failed = 1;
+                break;
+            }
+            size_t avail = (size_t)got / es;
+            for (int j = 0; j < bny && (size_t)j * bnx < avail; j++) {
+                size_t n_row = avail - (size_t)j * bnx;
+                if (n_row > (size_t)bnx) n_row = bnx;
+                decode_reals(&plane[(size_t)(box->lo[1] + j - lo[1]) * pw + (box->lo[0] - lo[0])],
+                             buf + (size_t)j * bnx * es, n_row, &fmt);
+            }
+        } else if (axis == 1) {
+            /* Y plane: one X row per box layer */
+            for (int k = 0; k < bnz; k++) {
+                double *dst = &plane[(size_t)(box->lo[2] + k - lo[2]) * pw + (box->lo[0] - lo[0])];
+                off_t pos = comp + ((off_t)k * bny + l) * bnx * es;
+                ssize_t got = pread(fd, buf, (size_t)bnx * es, pos);
+                if (got <= 0) {
+                    failed = 1;
+                    break;
+                }
+                decode_reals(dst, buf, (size_t)got / es, &fmt);
+            }
+            if (failed) break;
+        } else {
+            /* X plane: read the box component, keep column l of each row */
+            ssize_t got = pread(fd, buf, box_size * es, comp);
+            if (got <= 0) {
+                failed = 1;
+                break;
+            }
+            size_t avail = (size_t)got / es;
+            for (int k = 0; k < bnz; k++) {
+                for (int j = 0; j < bny; j++) {
+                    size_t src = ((size_t)k * bny + j) * bnx + l;
+                    if (src >= avail) break;
+                    decode_reals(&plane[(size_t)(box->lo[2] + k - lo[2]) * pw + (box->lo[1] + j - lo[1])],
+                                 buf + src * es, 1, &fmt);
+                }
+            }
+        }
+        n_read++;
+    }
+
+    if (fd >= 0) close(fd);
+    free(buf);
+    free(order);
+    return failed ? -1 : n_read;
+}
+
+/* Slice mode: read only the plane (axis, idx) of a variable into pf->plane */
+int read_variable_slice(PlotfileData *pf, int var_idx, int axis, int idx) {
+    char level_dir[MAX_PATH];
+    int pw = (axis == 0) ? pf->grid_dims[1] : pf->grid_dims[0];
+    int ph = (axis == 2) ? pf->grid_dims[1] : pf->grid_dims[2];
+
+    double *plane = (double *)realloc(pf->plane, (size_t)pw * ph * sizeof(double));
+    if (!plane) {
+        fprintf(stderr, "Error: Cannot allocate slice for %s\n", pf->variables[var_idx]);
+        return -1;
+    }
+    pf->plane = plane;
+    pf->plane_valid = 0;
+
+    if (level_dir_path(level_dir, pf->plotfile_dir, pf->current_level) < 0) return -1;
+    double t0 = wall_seconds();
+    int n_read = read_fab_plane(level_dir, pf->boxes, pf->n_boxes, var_idx,
+                                axis, idx, pf->plane, pf->grid_dims, pf->level_lo);
+    if (n_read < 0) {
+        fprintf(stderr, "Error: Cannot read %s %c=%d from %s\n",
+                pf->variables[var_idx], "XYZ"[axis], idx, level_dir);
+        return -1;
+    }
+
+    pf->plane_valid = 1;
+    pf->plane_var = var_idx;
+    pf->plane_axis = axis;
+    pf->plane_idx = idx;
+    printf("Loaded slice: %s %c=%d (%d of %d boxes, %.3f s)\n",
+           pf->variables[var_idx], "XYZ"[axis], idx, n_read, pf->n_boxes,
+           wall_seconds() - t0);
+    return 0;
+}
+
+/* Out-of-core mode: read layers [z0, z0 + nz) of component var_idx (layers
+ * relative to lo[2]) into a dense (nz, dims[1], dims[0]) chunk. A box
+ * stores Z slowest, so the layers a crossing box holds are one contiguous
+ * pread; boxes outside the range are not touched.
+ * Returns the number of boxes read, or -1 when a crossing box cannot be
+ * read or on allocation failure. */
+int read_fab_zrange(const char *level_dir, const Box *boxes, int n_boxes, int var_idx,
+                    int z0, int nz, void *dest, const int *dims, const int *lo) {
+    char path[MAX_PATH];
+    char line[MAX_LINE];
+    int chunk_dims[3] = {dims[0], dims[1], nz};
+    int chunk_lo[3] = {lo[0], lo[1], lo[2] + z0};
+    int g0 = lo[2] + z0, g1 = lo[2] + z0 + nz - 1;  /* Range in level index space */
+    size_t max_box_size = 0;
+    int n_read = 0;
+    int failed = 0;
+
+    memset(dest, 0, (size_t)dims[0] * dims[1] * nz * FIELD_ELEM_SIZE);
+
+    for (int b = 0; b < n_boxes; b++) {
+        size_t box_size = (size_t)(boxes[b].hi[0] - boxes[b].lo[0] + 1) *
+                          (boxes[b].hi[1] - boxes[b].lo[1] + 1) *
+                          (boxes[b].hi[2] - boxes[b].lo[2] + 1);
+        if (box_size > max_box_size) max_box_size = box_size;
+    }
+
+    int *order = plan_box_reads(boxes, n_boxes);
+    char *buf = (char *)malloc((max_box_size > 0 ? max_box_size : 1) * sizeof(double));
+    if (!order || !buf) {
+        free(order);
+        free(buf);
+        return -1;
+    }
+
+    int fd = -1;
+    const char *open_name = NULL;
+
+    for (int n = 0; n < n_boxes; n++) {
+        const Box *box = &boxes[order[n]];
+        int zlo = box->lo[2] > g0 ? box->lo[2] : g0;
+        int zhi = box->hi[2] < g1 ? box->hi[2] : g1;
+        if (zlo > zhi) continue;
+
+        if (!open_name || strcmp(open_name, box->filename) != 0) {
+            if (fd >= 0) close(fd);
+            snprintf(path, MAX_PATH, "%s/%s", level_dir, box->filename);
+            fd = open(path, O_RDONLY);
+            open_name = box->filename;
+            if (fd < 0) fprintf(stderr, "Error: Cannot open %s\n", path);
+        }
+        if (fd < 0) {
+            failed = 1;
+            break;
+        }
+
+        FabFormat fmt;
+        ssize_t hdr = pread(fd, line, MAX_LINE - 1, box->offset);
+        char *nl = hdr > 0 ? memchr(line, '\n', hdr) : NULL;
+        if (!nl) {
+            failed = 1;
+            break;
+        }
+        *nl = '\0';
+        parse_fab_header(line, &fmt);
+
+        size_t es = fmt.elem_size;
+        size_t layer = (size_t)(box->hi[0] - box->lo[0] + 1) * (box->hi[1] - box->lo[1] + 1);
+        size_t box_size = layer * (box->hi[2] - box->lo[2] + 1);
+        off_t comp = box->offset + (nl + 1 - line) + (off_t)var_idx * box_size * es;
+        ssize_t got = pread(fd, buf, (size_t)(zhi - zlo + 1) * layer * es,
+                            comp + (off_t)(zlo - box->lo[2]) * layer * es);
+        if (got <= 0) {
+            failed = 1;
+            break;
+        }
+
+        /* Scatter the layers read as if they were a box of their own */
+        Box part = *box;
+        part.lo[2] = zlo;
+        part.hi[2] = zhi;
+        scatter_box(&part, buf, (size_t)got, &fmt, dest, chunk_dims, chunk_lo);
+        n_read++;
+    }
+
+    if (fd >= 0) close(fd);
+    free(buf);
+    free(order);
+    return failed ? -1 : n_read;
+}
+
+/* Most layers in one out-of-core chunk: a quarter of the budget, at least one */
+static int ooc_chunk_depth(const PlotfileData *pf) {
+    size_t layer = (size_t)pf->grid_dims[0] * pf->grid_dims[1] * FIELD_ELEM_SIZE;
+    size_t depth = (size_t)ooc_mb * 1024 * 1024 / 4 / (layer > 0 ? layer : 1);
+    if (depth < 1) depth = 1;
+    if (depth > (size_t)pf->grid_dims[2]) depth = pf->grid_dims[2];
+    return (int)depth;
+}
+
+/* Drop the least recently used chunk. Returns -1 when none are left. */
+static int ooc_evict_lru(void) {
+    int victim = -1;
+    for (int c = 0; c < n_ooc_chunks; c++) {
+        if (victim < 0 || ooc_chunks[c].last_used < ooc_chunks[victim].last_used) victim = c;
+    }
+    if (victim < 0) return -1;
+
+    free(ooc_chunks[victim].data);
+    ooc_bytes -= ooc_chunks[victim].bytes;
+    ooc_chunks[victim] = ooc_chunks[--n_ooc_chunks];
+    return 0;
+}
+
+/* True when chunk oc holds component var_idx of the current level and timestep */
+static int ooc_chunk_matches(const OocChunk *oc, const PlotfileData *pf, int var_idx) {
+    return oc->var == var_idx && oc->level == pf->current_level &&
+           oc->dims[0] == pf->grid_dims[0] && oc->dims[1] == pf->grid_dims[1] &&
+           strcmp(oc->dir, pf->plotfile_dir) == 0;
+}
+
+/* The chunk of component var_idx holding layer z of the current level and
+ * timestep. The first chunk of a field holds only the layers around z, so
+ * a view opens with a small read. While the field is being scrubbed, each
+ * missing chunk is twice the largest one held, up to ooc_chunk_depth, and
+ * extends from z in the direction of travel. Missing chunks are read after
+ * evicting least recently used ones until chunks and overlay levels fit
+ * the --out-of-core budget; a chunk wider than the whole budget is still
+ * read on its own. The pointer stays valid until the next call. Returns
+ * NULL on failure. */
+const OocChunk *ooc_chunk(PlotfileData *pf, int var_idx, int z) {
+    char level_dir[MAX_PATH];
+    int depth = ooc_chunk_depth(pf);
+    const OocChunk *last = NULL;
+    int held = 0;
+
+    if (z < 0 || z >= pf->grid_dims[2]) return NULL;
+    for (int c = 0; c < n_ooc_chunks; c++) {
+        OocChunk *oc = &ooc_chunks[c];
+        if (!ooc_chunk_matches(oc, pf, var_idx)) continue;
+        if (z >= oc->z0 && z < oc->z0 + oc->dims[2]) {
+            oc->last_used = ++ooc_clock;
+            return oc;
+        }
+        if (oc->dims[2] > held) held = oc->dims[2];
+        if (!last || oc->last_used > last->last_used) last = oc;
+    }
+
+    int nz, z0;
+    if (!last) {
+        nz = 2 * OOC_NEAR_LAYERS + 1;
+        if (nz > depth) nz = depth;
+        z0 = z - nz / 2;
+    } else {
+        nz = (held < depth / 2) ? 2 * held : depth;
+        z0 = (z >= last->z0 + last->dims[2]) ? z : z - nz + 1;
+    }
+    if (nz > pf->grid_dims[2]) nz = pf->grid_dims[2];
+    if (z0 > pf->grid_dims[2] - nz) z0 = pf->grid_dims[2] - nz;
+    if (z0 < 0) z0 = 0;
+
+    size_t bytes = (size_t)pf->grid_dims[0] * pf->grid_dims[1] * nz * FIELD_ELEM_SIZE;
+    size_t budget = (size_t)ooc_mb * 1024 * 1024;
+    while (n_ooc_chunks > 0 &&
+           (n_ooc_chunks >= MAX_OOC_CHUNKS || ooc_level_bytes + ooc_bytes + bytes > budget)) {
+        ooc_evict_lru();
+    }
+
+    void *data = malloc(bytes);
+    if (!data) {
+        fprintf(stderr, "Error: Cannot allocate %.1f MB chunk for %s\n",
+                bytes / (1024.0 * 1024.0), pf->variables[var_idx]);
+        return NULL;
+    }
+
+    if (level_dir_path(level_dir, pf->plotfile_dir, pf->current_level) < 0) {
+        free(data);
+        return NULL;
+    }
+    double t0 = wall_seconds();
+    int n_read = read_fab_zrange(level_dir, pf->boxes, pf->n_boxes, var_idx, z0, nz,
+                                 data, pf->grid_dims, pf->level_lo);
+    if (n_read < 0) {
+        fprintf(stderr, "Error: Cannot read %s Z=%d-%d from %s\n",
+                pf->variables[var_idx], z0, z0 + nz - 1, level_dir);
+        free(data);
+        return NULL;
+    }
+
+    OocChunk *oc = &ooc_chunks[n_ooc_chunks++];
+    memcpy(oc->dir, pf->plotfile_dir, MAX_PATH);
+    oc->level = pf->current_level;
+    oc->var = var_idx;
+    oc->z0 = z0;
+    oc->dims[0] = pf->grid_dims[0];
+    oc->dims[1] = pf->grid_dims[1];
+    oc->dims[2] = nz;
+    oc->data = data;
+    oc->bytes = bytes;
+    oc->last_used = ++ooc_clock;
+    ooc_bytes += bytes;
+    printf("Loaded chunk: %s Z=%d-%d (%d of %d boxes, %.1f MB resident, %.3f s)\n",
+           pf->variables[var_idx], z0, z0 + nz - 1, n_read, pf->n_boxes,
+           ooc_bytes / (1024.0 * 1024.0), wall_seconds() - t0);
+    return oc;
+}
+
+/* Out-of-core mode: refuse to load n_fields full 3D fields of the current
+ * level when they would not fit the budget */
+static int ooc_over_budget(const PlotfileData *pf, int n_fields, const char *what) {
+    if (ooc_mb <= 0) return 0;
+    double mb = (double)pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2] *
+                FIELD_ELEM_SIZE * n_fields / (1024.0 * 1024.0);
+    if (mb <= ooc_mb) return 0;
+    fprintf(stderr, "%s needs %.0f MB of full 3D fields, over the --out-of-core budget of %d MB\n",
+            what, mb, ooc_mb);
+    return 1;
+}
+
+/* Pass a posix_fadvise hint (POSIX_FADV_WILLNEED or POSIX_FADV_DONTNEED)
+ * for the bytes a sweep reads from one timestep: component var_idx of every
+ * box on the level, or with axis >= 0 only what read_fab_plane fetches for
+ * plane idx. The box layout comes from the run index (Cell_H is parsed and
+ * indexed otherwise). FAB header lengths are not read; a box's extent is
+ * taken up to the next FAB in its file, split evenly over n_vars
+ * components, and each range is widened by MAX_LINE to cover the header.
+ * Returns the number of bytes advised. */
+size_t advise_timestep_reads(const char *plotfile_dir, int level, int ndim, int n_vars,
+                             int var_idx, int axis, int idx, int advice) {
+    char path[MAX_PATH];
+    Box *boxes = NULL;
+    int capacity = 0, n_boxes = 0;
+    RangeIndex ri = {0};
+    size_t advised = 0;
+
+    if (n_vars <= 0 || var_idx < 0 || var_idx >= n_vars) return 0;
+    if (run_index_load_level(plotfile_dir, level, &boxes, &capacity, &n_boxes, &ri) < 0) {
+        snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", plotfile_dir, level);
+        if (parse_cell_h(path, ndim, &boxes, &capacity, &n_boxes, &ri) < 0) {
+            free(boxes);
+            free_range_index(&ri);
+            return 0;
+        }
+        run_index_store_level(plotfile_dir, level, boxes, n_boxes, &ri);
+    }
+
+    int lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    box_bounds(boxes, n_boxes, ndim, lo, hi);
+    int *order = plan_box_reads(boxes, n_boxes);
+    int fd = -1;
+    off_t file_size = 0;
+
+    for (int n = 0; order && n < n_boxes; n++) {
+        const Box *box = &boxes[order[n]];
+        if (n == 0 || strcmp(box->filename, boxes[order[n - 1]].filename) != 0) {
+            struct stat st;
+            if (fd >= 0) close(fd);
+            snprintf(path, MAX_PATH, "%s/Level_%d/%s", plotfile_dir, level, box->filename);
+            fd = open(path, O_RDONLY);
+            file_size = (fd >= 0 && fstat(fd, &st) == 0) ? st.st_size : 0;
+        }
+        if (fd < 0 || box->offset < 0 || box->offset >= file_size) continue;
+        if (axis >= 0 && (idx + lo[axis] < box->lo[axis] || idx + lo[axis] > box->hi[axis])) {
+            continue;
+        }
+
+        /* Boxes arrive in offset order, so the next one in the file ends this one */
+        off_t end = file_size;
+        if (n + 1 < n_boxes && strcmp(boxes[order[n + 1]].filename, box->filename) == 0 &&
+            boxes[order[n + 1]].offset > box->offset) {
+            end = boxes[order[n + 1]].offset;
+        }
+        off_t comp_bytes = (end - box->offset) / n_vars;
+        off_t start = box->offset + (off_t)var_idx * comp_bytes;
+        off_t len = comp_bytes + MAX_LINE;
+
+        /* A Z plane is one contiguous layer of the component */
+        size_t box_size = (size_t)(box->hi[0] - box->lo[0] + 1) *
+                          (box->hi[1] - box->lo[1] + 1) *
+                          (box->hi[2] - box->lo[2] + 1);
+        off_t elem_size = (off_t)(comp_bytes / (off_t)box_size);
+        if (axis == 2 && (elem_size == 4 || elem_size == 8)) {
+            off_t layer_bytes = (off_t)(box->hi[0] - box->lo[0] + 1) *
+                                (box->hi[1] - box->lo[1] + 1) * elem_size;
+            start += (off_t)(idx + lo[2] - box->lo[2]) * layer_bytes;
+            len = layer_bytes + MAX_LINE;
+        }
+        if (start + len > end) len = end - start;
+        if (len <= 0) continue;
+        posix_fadvise(fd, start, len, advice);
+        advised += (size_t)len;
+    }
+
+    if (fd >= 0) close(fd);
+    free(order);
+    free(boxes);
+    free_range_index(&ri);
+    return advised;
+}
+
+/* ========== Slice Sidecar Cache ========== */
+
+/* Release the sidecars of the previous run */
+static void close_slice_caches(void) {
+    for (int c = 0; c < n_slice_caches; c++) {
+        if (slice_caches[c].fd >= 0) close(slice_caches[c].fd);
+        free(slice_caches[c].entries);
+        free(slice_caches[c].offsets);
+    }
+    memset(slice_caches, 0, sizeof(slice_caches));
+    n_slice_caches = 0;
+    slice_cache_dir[0] = '\0';
+}
+
+/* Plane extent along axis of a dims grid, as extract_field_plane lays it out */
+static size_t plane_size(const int *dims, int axis) {
+    return (size_t)((axis == 0) ? dims[1] : dims[0]) * ((axis == 2) ? dims[1] : dims[2]);
+}
+
+/* Read the tables of one sidecar and keep its descriptor for plane reads */
+static int open_slice_cache(const char *path, SliceCache *sc) {
+    char magic[8];
+    int err = 0;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+
+    memset(sc, 0, sizeof(SliceCache));
+    index_get(fp, magic, sizeof(magic), &err);
+    int version = index_get_int(fp, &err);
+    sc->axis = index_get_int(fp, &err);
+    for (int d = 0; d < 3; d++) sc->dims[d] = index_get_int(fp, &err);
+    sc->n_entries = index_get_int(fp, &err);
+    index_get(fp, sc->var, sizeof(sc->var), &err);
+    sc->var[sizeof(sc->var) - 1] = '\0';
+    if (err || memcmp(magic, SLICE_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version != SLICE_CACHE_VERSION || sc->axis < 0 || sc->axis > 2 ||
+        sc->dims[0] <= 0 || sc->dims[1] <= 0 || sc->dims[2] <= 0 || sc->n_entries <= 0) {
+        fclose(fp);
+        return -1;
+    }
+    sc->n_layers = sc->dims[sc->axis];
+    sc->plane_size = plane_size(sc->dims, sc->axis);
+
+    sc->entries = (SliceCacheEntry *)calloc(sc->n_entries, sizeof(SliceCacheEntry));
+    sc->offsets = (int64_t *)malloc((size_t)sc->n_entries * sc->n_layers * sizeof(int64_t));
+    if (!sc->entries || !sc->offsets) err = 1;
+    for (int i = 0; i < sc->n_entries && !err; i++) {
+        index_get(fp, sc->entries[i].name, sizeof(sc->entries[i].name), &err);
+        sc->entries[i].name[sizeof(sc->entries[i].name) - 1] = '\0';
+        index_get(fp, &sc->entries[i].mtime_ns, sizeof(int64_t), &err);
+    }
+    index_get(fp, sc->offsets, (size_t)sc->n_entries * sc->n_layers * sizeof(int64_t), &err);
+    fclose(fp);
+
+    sc->fd = err ? -1 : open(path, O_RDONLY);
+    if (sc->fd < 0) {
+        free(sc->entries);
+        free(sc->offsets);
+        memset(sc, 0, sizeof(SliceCache));
+        return -1;
+    }
+    return 0;
+}
+
+/* Split a plotfile path into the run directory holding it and its name
+ * there; a bare name lives in "." */
+static void split_plotfile_path(const char *plotfile_dir, char *run_dir, char *name) {
+    size_t len = strlen(plotfile_dir);
+    while (len > 1 && plotfile_dir[len - 1] == '/') len--;
+    size_t slash = len;
+    while (slash > 0 && plotfile_dir[slash - 1] != '/') slash--;
+    memcpy(name, plotfile_dir + slash, len - slash);
+    name[len - slash] = '\0';
+    if (slash == 0) {
+        strcpy(run_dir, ".");
+    } else {
+        size_t dir_len = slash > 1 ? slash - 1 : 1;  /* Keep "/" for the root */
+        memcpy(run_dir, plotfile_dir, dir_len);
+        run_dir[dir_len] = '\0';
+    }
+}
+
+/* Open every sidecar in a run directory, once per run */
+static void open_slice_caches(const char *run_dir) {
+    if (strcmp(slice_cache_dir, run_dir) == 0) return;
+    close_slice_caches();
+    memcpy(slice_cache_dir, run_dir, MAX_PATH);
+
+    DIR *dir = opendir(slice_cache_dir);
+    if (!dir) return;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL && n_slice_caches < MAX_SLICE_CACHES) {
+        char path[MAX_PATH];
+        size_t len = strlen(de->d_name);
+        if (strncmp(de->d_name, SLICE_CACHE_PREFIX, strlen(SLICE_CACHE_PREFIX)) != 0 ||
+            (len > 4 && strcmp(de->d_name + len - 4, ".tmp") == 0)) {
+            continue;
+        }
+        if (snprintf(path, MAX_PATH, "%s/%s", slice_cache_dir, de->d_name) >= MAX_PATH) continue;
+        if (open_slice_cache(path, &slice_caches[n_slice_caches]) == 0) {
+            printf("Slice cache: %s along %c, %d timesteps\n", slice_caches[n_slice_caches].var,
+                   "XYZ"[slice_caches[n_slice_caches].axis],
+                   slice_caches[n_slice_caches].n_entries);
+            n_slice_caches++;
+        }
+    }
+    closedir(dir);
+}
+
+/* Sidecar holding var_idx of pf's timestep along axis (any axis for -1),
+ * with the timestep's entry in *entry. Sidecars are looked up in the
+ * directory holding the plotfile, so they serve a plotfile opened alone
+ * and timesteps found before the run scan finishes. The timestep must
+ * still have the Header it had when the sidecar was built. */
+static SliceCache *find_slice_cache(const PlotfileData *pf, int var_idx, int axis, int *entry) {
+    char run_dir[MAX_PATH], name[MAX_PATH];
+    if (pf->current_level != 0 || var_idx < 0 || var_idx >= pf->n_vars) return NULL;
+    split_plotfile_path(pf->plotfile_dir, run_dir, name);
+    open_slice_caches(run_dir);
+    if (n_slice_caches == 0) return NULL;
+
+    for (int c = 0; c < n_slice_caches; c++) {
+        SliceCache *sc = &slice_caches[c];
+        if ((axis >= 0 && sc->axis != axis) || strcmp(sc->var, pf->variables[var_idx]) != 0 ||
+            sc->dims[0] != pf->grid_dims[0] || sc->dims[1] != pf->grid_dims[1] ||
+            sc->dims[2] != pf->grid_dims[2]) {
+            continue;
+        }
+
+        /* Sidecars list the run in timeline order, so try the same slot first */
+        int e = (current_timestep < sc->n_entries &&
+                 strcmp(sc->entries[current_timestep].name, name) == 0) ? current_timestep : -1;
+        for (int i = 0; i < sc->n_entries && e < 0; i++) {
+            if (strcmp(sc->entries[i].name, name) == 0) e = i;
+        }
+        if (e < 0) continue;
+
+        SliceCacheEntry *se = &sc->entries[e];
+        if (se->valid == 0) {
+            char path[MAX_PATH];
+            struct stat st;
+            se->valid = (snprintf(path, MAX_PATH, "%s/Header", pf->plotfile_dir) < MAX_PATH &&
+                         stat(path, &st) == 0 && stat_mtime_ns(&st) == se->mtime_ns) ? 1 : -1;
+        }
+        if (se->valid < 0) continue;
+        *entry = e;
+        return sc;
+    }
+    return NULL;
+}
+
+/* True when a sidecar can serve the current timestep's planes of var_idx */
+int slice_cache_covers(const PlotfileData *pf, int var_idx) {
+    int entry;
+    return find_slice_cache(pf, var_idx, -1, &entry) != NULL;
+}
+
+/* Read plane idx along axis of var_idx from a sidecar, laid out as
+ * extract_slice does. Returns -1 when no sidecar holds it. */
+int slice_cache_read(const PlotfileData *pf, int var_idx, int axis, int idx, double *slice) {
+    int e;
+    SliceCache *sc = find_slice_cache(pf, var_idx, axis, &e);
+    if (!sc || idx < 0 || idx >= sc->n_layers) return -1;
+    int64_t offset = sc->offsets[(size_t)e * sc->n_layers + idx];
+    if (offset <= 0) return -1;
+
+    /* Planes are float32; widen in place from the back */
+    size_t bytes = sc->plane_size * sizeof(float);
+    float *values = (float *)slice;
+    if (pread(sc->fd, values, bytes, (off_t)offset) != (ssize_t)bytes) return -1;
+    for (size_t i = sc->plane_size; i-- > 0;) {
+        slice[i] = values[i];
+    }
+    return 0;
+}
+
+/* Headless precompute for --build-slice-cache: cut every layer of one
+ * variable along axis out of level 0 of every timestep in the run and
+ * write them to the run's sidecar. Timesteps without the variable, or with
+ * a different grid than the first, are left out. */
+int build_slice_cache(const char *base_dir, const char *prefix, const char *var_name, int axis) {
+    char path[MAX_PATH], tmp_path[MAX_PATH];
+    char magic[8] = SLICE_CACHE_MAGIC, var[64] = {0};
+    int dims[3] = {0, 0, 0};
+    int err = 0;
+
+    if (scan_timesteps(base_dir, prefix) <= 0) {
+        fprintf(stderr, "Error: No plotfiles with prefix '%s' in %s\n", prefix, base_dir);
+        return -1;
+    }
+    poll_timestep_scan(1);
+
+    PlotfileData *pf = (PlotfileData *)calloc(1, sizeof(PlotfileData));
+    if (!pf) return -1;
+
+    /* The first timestep with the variable fixes the grid */
+    for (int t = 0; t < n_timesteps && dims[0] == 0; t++) {
+        strncpy(pf->plotfile_dir, timestep_paths[t], MAX_PATH - 1);
+        pf->n_boxes = 0;
+        if (read_header(pf) == 0 && find_variable_index(pf, var_name) >= 0 && read_cell_h(pf) == 0) {
+            memcpy(dims, pf->grid_dims, sizeof(dims));
+        }
+    }
+    if (dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0) {
+        fprintf(stderr, "Error: Variable '%s' not found in %s\n", var_name, base_dir);
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+
+    int n_layers = dims[axis];
+    size_t n_plane = plane_size(dims, axis);
+    double *slice = (double *)malloc(n_plane * sizeof(double));
+    float *values = (float *)malloc(n_plane * sizeof(float));
+    int64_t *offsets = (int64_t *)calloc((size_t)n_timesteps * n_layers, sizeof(int64_t));
+    strncpy(var, var_name, sizeof(var) - 1);
+    int named = snprintf(path, MAX_PATH, "%s/%s%s_%c", base_dir, SLICE_CACHE_PREFIX, var,
+                         "XYZ"[axis]) < MAX_PATH &&
+                snprintf(tmp_path, MAX_PATH, "%s.tmp", path) < MAX_PATH;
+    FILE *fp = (named && slice && values && offsets) ? fopen(tmp_path, "wb") : NULL;
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot write %s\n", tmp_path);
+        free(slice);
+        free(values);
+        free(offsets);
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+
+    /* Header and timestep table; the offset table is filled in at the end */
+    index_put(fp, magic, sizeof(magic), &err);
+    index_put_int(fp, SLICE_CACHE_VERSION, &err);
+    index_put_int(fp, axis, &err);
+    for (int d = 0; d < 3; d++) index_put_int(fp, dims[d], &err);
+    index_put_int(fp, n_timesteps, &err);
+    index_put(fp, var, sizeof(var), &err);
+    for (int t = 0; t < n_timesteps; t++) {
+        char name[64] = {0};
+        struct stat st;
+        int64_t mtime = 0;
+        const char *slash = strrchr(timestep_paths[t], '/');
+        strncpy(name, slash ? slash + 1 : timestep_paths[t], sizeof(name) - 1);
+        snprintf(path, MAX_PATH, "%s/Header", timestep_paths[t]);
+        if (stat(path, &st) == 0) mtime = stat_mtime_ns(&st);
+        index_put(fp, name, sizeof(name), &err);
+        index_put(fp, &mtime, sizeof(mtime), &err);
+    }
+    long offsets_pos = ftell(fp);
+    index_put(fp, offsets, (size_t)n_timesteps * n_layers * sizeof(int64_t), &err);
+
+    /* One sequential sweep over the run, with the Series read-ahead hints */
+    int stored = 0;
+    double t0 = wall_seconds();
+    sweep_mode = 1;
+    for (int t = 0; t < n_timesteps && !err; t++) {
+        strncpy(pf->plotfile_dir, timestep_paths[t], MAX_PATH - 1);
+        pf->current_level = 0;
+        pf->n_boxes = 0;
+        if (read_header(pf) < 0 || read_cell_h(pf) < 0) continue;
+        int var_idx = find_variable_index(pf, var_name);
+        if (var_idx < 0 || memcmp(pf->grid_dims, dims, sizeof(dims)) != 0) {
+            printf("Skipping %s: no %s on a %d x %d x %d grid\n", timestep_paths[t], var_name,
+                   dims[0], dims[1], dims[2]);
+            continue;
+        }
+        if (t + 1 < n_timesteps) {
+            advise_timestep_reads(timestep_paths[t + 1], 0, pf->ndim, pf->n_vars, var_idx, -1, 0,
+                                  POSIX_FADV_WILLNEED);
+        }
+        if (read_variable_data(pf, var_idx) < 0 || !pf->data) continue;
+
+        for (int layer = 0; layer < n_layers; layer++) {
+            extract_field_plane(pf->data, dims, slice, axis, layer);
+            for (size_t i = 0; i < n_plane; i++) {
+                values[i] = (float)slice[i];
+            }
+            offsets[(size_t)t * n_layers + layer] = ftell(fp);
+            index_put(fp, values, n_plane * sizeof(float), &err);
+        }
+        stored++;
+
+        release_mapped_files();
+        advise_timestep_reads(timestep_paths[t], 0, pf->ndim, pf->n_vars, var_idx, -1, 0,
+                              POSIX_FADV_DONTNEED);
+    }
+    sweep_mode = 0;
+
+    if (fseek(fp, offsets_pos, SEEK_SET) != 0) err = 1;
+    index_put(fp, offsets, (size_t)n_timesteps * n_layers * sizeof(int64_t), &err);
+    if (fclose(fp) != 0) err = 1;
+    snprintf(path, MAX_PATH, "%s/%s%s_%c", base_dir, SLICE_CACHE_PREFIX, var, "XYZ"[axis]);
+    if (err || rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Error: Cannot write %s\n", path);
+        unlink(tmp_path);
+    } else {
+        printf("Wrote %s: %d of %d timesteps, %d %c layers of %s (%.1f MB in %.1f s)\n",
+               path, stored, n_timesteps, n_layers, "XYZ"[axis], var,
+               (double)stored * n_layers * n_plane * sizeof(float) / (1024.0 * 1024.0),
+               wall_seconds() - t0);
+    }
+
+    field_cache_release(pf->data);
+    free_plotfile_metadata(pf);
+    free(pf);
+    free(slice);
+    free(values);
+    free(offsets);
+    return err ? -1 : 0;
+}
+
+/* ========== Statistics Cache ========== */
+
+/* Mean, standard deviation and skewness of n values into m[0..2] */
+static void plane_moments(const double *values, size_t n, double *m) {
+    double sum = 0.0, sum_sq = 0.0, sum_third = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += values[i];
+        sum_sq += values[i] * values[i];
+    }
+    double mean = n > 0 ? sum / n : 0.0;
+    double variance = n > 0 ? (sum_sq / n) - (mean * mean) : 0.0;
+    double std = (variance > 0) ? sqrt(variance) : 0.0;
+
+    /* Second pass: third moment about the mean */
+    for (size_t i = 0; i < n; i++) {
+        double diff = values[i] - mean;
+        sum_third += diff * diff * diff;
+    }
+
+    /* Skewness = E[(X - mu)^3] / sigma^3 */
+    m[0] = mean;
+    m[1] = std;
+    m[2] = (std > 0) ? (sum_third / n) / (std * std * std) : 0.0;
+}
+
+/* Moments of every layer along axis of a loaded 3D field */
+static int field_layer_moments(const void *data, const int *dims, int axis, double *moments) {
+    size_t n = (size_t)((axis == 0) ? dims[1] : dims[0]) * ((axis == 2) ? dims[1] : dims[2]);
+    double *plane = (double *)malloc((n > 0 ? n : 1) * sizeof(double));
+    if (!plane) return -1;
+    for (int s = 0; s < dims[axis]; s++) {
+        extract_field_plane(data, dims, plane, axis, s);
+        plane_moments(plane, n, &moments[(size_t)s * STATS_MOMENTS]);
+    }
+    free(plane);
+    return 0;
+}
+
+/* Out-of-core mode: moments of every layer along axis, streamed chunk by
+ * chunk. A Z layer lies whole in one chunk; X and Y layers cross every
+ * chunk, so their sums are kept about the layer's first value, which keeps
+ * the variance and third moment accurate in a single pass. */
+static int ooc_layer_moments(PlotfileData *pf, int var_idx, int axis, double *moments) {
+    const int *dims = pf->grid_dims;
+    int n_layers = dims[axis];
+    int depth = ooc_chunk_depth(pf);
+    size_t n_part = (axis == 2) ? (size_t)dims[0] * dims[1]
+                                : (size_t)((axis == 1) ? dims[0] : dims[1]) * depth;
+    double *plane = (double *)malloc((n_part > 0 ? n_part : 1) * sizeof(double));
+    double *sums = (double *)calloc((size_t)n_layers * 4, sizeof(double));  /* Shift, S1-S3 */
+    if (!plane || !sums) {
+        free(plane);
+        free(sums);
+        return -1;
+    }
+
+    for (int z = 0; z < dims[2];) {
+        const OocChunk *oc = ooc_chunk(pf, var_idx, z);
+        if (!oc) {
+            free(plane);
+            free(sums);
+            return -1;
+        }
+        if (axis == 2) {
+            for (int k = 0; k < oc->dims[2]; k++) {
+                extract_field_plane(oc->data, oc->dims, plane, 2, k);
+                plane_moments(plane, n_part, &moments[(size_t)(oc->z0 + k) * STATS_MOMENTS]);
+            }
+        } else {
+            size_t n = (size_t)((axis == 1) ? dims[0] : dims[1]) * oc->dims[2];
+            for (int s = 0; s < n_layers; s++) {
+                double *sm = &sums[(size_t)s * 4];
+                extract_field_plane(oc->data, oc->dims, plane, axis, s);
+                if (z == 0) sm[0] = plane[0];
+                for (size_t i = 0; i < n; i++) {
+                    double d = plane[i] - sm[0];
+                    sm[1] += d;
+                    sm[2] += d * d;
+                    sm[3] += d * d * d;
+                }
+            }
+        }
+        z = oc->z0 + oc->dims[2];
+    }
+
+    if (axis != 2) {
+        double n = (double)((axis == 1) ? dims[0] : dims[1]) * dims[2];
+        for (int s = 0; s < n_layers; s++) {
+            const double *sm = &sums[(size_t)s * 4];
+            double a = sm[1] / n, b = sm[2] / n, c = sm[3] / n;
+            double variance = b - a * a;
+            double std = (variance > 0) ? sqrt(variance) : 0.0;
+            double third = c - 3.0 * a * b + 2.0 * a * a * a;
+            double *m = &moments[(size_t)s * STATS_MOMENTS];
+            m[0] = sm[0] + a;
+            m[1] = std;
+            m[2] = (std > 0) ? third / (std * std * std) : 0.0;
+        }
+    }
+    free(plane);
+    free(sums);
+    return 0;
+}
+
+/* File holding a plotfile's statistics, and the plotfile's name in it. The
+ * path is left empty, so no file opens, when it does not fit. */
+static void stats_location(const char *plotfile_dir, char *path, char *name) {
+    size_t len = strlen(run_index_dir);
+    int n;
+    if (len > 0 && strncmp(plotfile_dir, run_index_dir, len) == 0 && plotfile_dir[len] == '/') {
+        n = snprintf(path, MAX_PATH, "%s/%s", run_index_dir, STATS_CACHE_FILE);
+        snprintf(name, 64, "%s", plotfile_dir + len + 1);
+    } else {
+        n = snprintf(path, MAX_PATH, "%s/%s", plotfile_dir, STATS_CACHE_FILE);
+        snprintf(name, 64, ".");
+    }
+    if (n >= MAX_PATH) path[0] = '\0';
+}
+
+/* Header mtime of a plotfile, 0 when it cannot be read */
+static int64_t header_mtime_ns(const char *plotfile_dir) {
+    char path[MAX_PATH];
+    struct stat st;
+    snprintf(path, MAX_PATH, "%s/Header", plotfile_dir);
+    return stat(path, &st) == 0 ? stat_mtime_ns(&st) : 0;
+}
+
+static void write_stats_record(FILE *fp, const StatsEntry *se, int *err) {
+    index_put(fp, se->name, sizeof(se->name), err);
+    index_put(fp, se->var, sizeof(se->var), err);
+    index_put_int(fp, se->level, err);
+    index_put_int(fp, se->axis, err);
+    index_put_int(fp, se->n_layers, err);
+    index_put(fp, &se->mtime_ns, sizeof(se->mtime_ns), err);
+    index_put(fp, se->moments, (size_t)se->n_layers * STATS_MOMENTS * sizeof(double), err);
+}
+
+/* Returns -1 at the end of the file or on a damaged record */
+static int read_stats_record(FILE *fp, StatsEntry *se) {
+    int err = 0;
+    memset(se, 0, sizeof(StatsEntry));
+    index_get(fp, se->name, sizeof(se->name), &err);
+    index_get(fp, se->var, sizeof(se->var), &err);
+    se->level = index_get_int(fp, &err);
+    se->axis = index_get_int(fp, &err);
+    se->n_layers = index_get_int(fp, &err);
+    index_get(fp, &se->mtime_ns, sizeof(se->mtime_ns), &err);
+    if (err || se->n_layers <= 0 || se->n_layers > (1 << 24)) return -1;
+    se->name[sizeof(se->name) - 1] = '\0';
+    se->var[sizeof(se->var) - 1] = '\0';
+    se->moments = (double *)malloc((size_t)se->n_layers * STATS_MOMENTS * sizeof(double));
+    if (!se->moments) return -1;
+    index_get(fp, se->moments, (size_t)se->n_layers * STATS_MOMENTS * sizeof(double), &err);
+    if (err) {
+        free(se->moments);
+        se->moments = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static StatsEntry *find_stats_entry(const char *name, const char *var, int level, int axis) {
+    for (int i = 0; i < n_stats_cache; i++) {
+        StatsEntry *se = &stats_cache[i];
+        if (se->level == level && se->axis == axis && strcmp(se->name, name) == 0 &&
+            strcmp(se->var, var) == 0) return se;
+    }
+    return NULL;
+}
+
+/* Install an entry, taking over its moments; it replaces any entry with
+ * the same key */
+static void put_stats_entry(StatsEntry *se) {
+    StatsEntry *old = find_stats_entry(se->name, se->var, se->level, se->axis);
+    if (old) {
+        free(old->moments);
+        *old = *se;
+        return;
+    }
+    if (n_stats_cache >= stats_cache_capacity) {
+        int capacity = stats_cache_capacity > 0 ? stats_cache_capacity * 2 : 64;
+        StatsEntry *grown = (StatsEntry *)realloc(stats_cache, capacity * sizeof(StatsEntry));
+        if (!grown) {
+            free(se->moments);
+            return;
+        }
+        stats_cache = grown;
+        stats_cache_capacity = capacity;
+    }
+    stats_cache[n_stats_cache++] = *se;
+}
+
+/* Rewrite the statistics file with only the live entries */
+static void compact_stats_cache(void) {
+    char tmp_path[MAX_PATH];
+    char magic[8] = STATS_CACHE_MAGIC;
+    int err = 0;
+    if (snprintf(tmp_path, MAX_PATH, "%s.tmp", stats_cache_path) >= MAX_PATH) return;
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp) return;
+    index_put(fp, magic, sizeof(magic), &err);
+    index_put_int(fp, STATS_CACHE_VERSION, &err);
+    for (int i = 0; i < n_stats_cache; i++) write_stats_record(fp, &stats_cache[i], &err);
+    if (fclose(fp) != 0) err = 1;
+    if (err || rename(tmp_path, stats_cache_path) != 0) unlink(tmp_path);
+}
+
+/* Read a statistics file into memory, unless it is the one already loaded */
+static void load_stats_cache(const char *path) {
+    char magic[8];
+    int err = 0;
+    if (strcmp(path, stats_cache_path) == 0) return;
+
+    for (int i = 0; i < n_stats_cache; i++) free(stats_cache[i].moments);
+    n_stats_cache = 0;
+    strncpy(stats_cache_path, path, MAX_PATH - 1);
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return;
+    index_get(fp, magic, sizeof(magic), &err);
+    int version = index_get_int(fp, &err);
+    if (err || memcmp(magic, STATS_CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version != STATS_CACHE_VERSION) {
+        fclose(fp);
+        return;
+    }
+
+    /* A damaged tail is simply dropped */
+    StatsEntry se;
+    int n_records = 0;
+    while (read_stats_record(fp, &se) == 0) {
+        put_stats_entry(&se);
+        n_records++;
+    }
+    fclose(fp);
+
+    /* Records replaced since have piled up: keep only the live ones */
+    if (n_records > 2 * n_stats_cache + 64) compact_stats_cache();
+}
+
+/* Cached per-layer moments of one (plotfile, level, variable, axis), or
+ * NULL when none are stored or the plotfile has changed since */
+const StatsEntry *stats_cache_lookup(const char *plotfile_dir, int level, const char *var, int axis) {
+    char path[MAX_PATH], name[64];
+    stats_location(plotfile_dir, path, name);
+    load_stats_cache(path);
+    StatsEntry *se = find_stats_entry(name, var, level, axis);
+    if (!se || se->mtime_ns != header_mtime_ns(plotfile_dir)) return NULL;
+    return se;
+}
+
+/* Moments of layer s from the cache into m, or -1 when not computed */
+int stats_cache_layer(const char *plotfile_dir, int level, const char *var, int axis, int s,
+                      double *m) {
+    const StatsEntry *se = stats_cache_lookup(plotfile_dir, level, var, axis);
+    if (!se || s < 0 || s >= se->n_layers || isnan(se->moments[(size_t)s * STATS_MOMENTS])) {
+        return -1;
+    }
+    memcpy(m, &se->moments[(size_t)s * STATS_MOMENTS], STATS_MOMENTS * sizeof(double));
+    return 0;
+}
+
+/* Record per-layer moments and append them to the statistics file. Layers
+ * whose mean is NaN keep whatever was stored for the same Header. */
+void stats_cache_store(const char *plotfile_dir, int level, const char *var, int axis,
+                       int n_layers, const double *moments) {
+    char path[MAX_PATH];
+    StatsEntry se;
+    int err = 0;
+
+    memset(&se, 0, sizeof(se));
+    stats_location(plotfile_dir, path, se.name);
+    load_stats_cache(path);
+    strncpy(se.var, var, sizeof(se.var) - 1);
+    se.level = level;
+    se.axis = axis;
+    se.n_layers = n_layers;
+    se.mtime_ns = header_mtime_ns(plotfile_dir);
+    se.moments = (double *)malloc((size_t)n_layers * STATS_MOMENTS * sizeof(double));
+    if (!se.moments) return;
+    memcpy(se.moments, moments, (size_t)n_layers * STATS_MOMENTS * sizeof(double));
+
+    const StatsEntry *old = find_stats_entry(se.name, se.var, level, axis);
+    if (old && old->mtime_ns == se.mtime_ns && old->n_layers == n_layers) {
+        for (int s = 0; s < n_layers; s++) {
+            size_t m = (size_t)s * STATS_MOMENTS;
+            if (isnan(se.moments[m])) memcpy(&se.moments[m], &old->moments[m], STATS_MOMENTS * sizeof(double));
+        }
+    }
+
+    /* Read-only location: keep the entry for this session only */
+    FILE *fp = fopen(path, "ab");
+    if (fp) {
+        if (fseek(fp, 0, SEEK_END) == 0 && ftell(fp) == 0) {
+            char magic[8] = STATS_CACHE_MAGIC;
+            index_put(fp, magic, sizeof(magic), &err);
+            index_put_int(fp, STATS_CACHE_VERSION, &err);
+        }
+        write_stats_record(fp, &se, &err);
+        fclose(fp);
+    }
+    put_stats_entry(&se);
+}
+
+/* Load a variable for display. In slice mode, or when a slice sidecar
+ * holds the variable, only the plane in view is read, lazily from
+ * extract_slice; otherwise the full 3D field is loaded. */
+int load_variable(PlotfileData *pf, int var_idx) {
+    if (!slice_mode && !slice_cache_covers(pf, var_idx)) return read_variable_data(pf, var_idx);
+
+    /* A cached full field serves the plane without any I/O */
+    void *cached = field_cache_acquire(pf->plotfile_dir, pf->current_level, var_idx);
+    field_cache_release(pf->data);
+    pf->data = cached;
+    pf->plane_valid = 0;
+    return 0;
+}
+
+/* Make sure the full 3D field of the current variable is resident */
+int ensure_full_data(PlotfileData *pf) {
+    if (pf->data) return 0;
+    if (ooc_over_budget(pf, 1, pf->variables[pf->current_var])) return -1;
+    return read_variable_data(pf, pf->current_var);
+}
+
+/* True when the current variable can be displayed */
+int field_available(PlotfileData *pf) {
+    return pf->data != NULL || slice_mode || slice_cache_covers(pf, pf->current_var);
+}
+
+/* Drop the companion fields kept for quiver and map overlays */
+void free_resident_fields(PlotfileData *pf) {
+    for (int r = 0; r < pf->n_resident; r++) {
+        free(pf->resident_data[r]);
+        pf->resident_data[r] = NULL;
+    }
+    pf->n_resident = 0;
+}
+
+/* Full 3D field of a companion variable: the displayed data when it is that
+ * variable, otherwise a resident copy. NULL if not loaded. */
+void *resident_field(PlotfileData *pf, int var_idx) {
+    if (var_idx == pf->current_var && pf->data) return pf->data;
+    if (strcmp(pf->resident_dir, pf->plotfile_dir) != 0 ||
+        pf->resident_level != pf->current_level) return NULL;
+    for (int r = 0; r < pf->n_resident; r++) {
+        if (pf->resident_var[r] == var_idx) return pf->resident_data[r];
+    }
+    return NULL;
+}
+
+/* Make companion variables (quiver components, lon_m/lat_m) resident for the
+ * current timestep and level. All missing ones are read in a single pass
+ * over the Cell_D files, and later calls cost no I/O. */
+int load_resident_fields(PlotfileData *pf, const int *vars, int n_vars) {
+    int missing[MAX_RESIDENT_FIELDS];
+    int n_missing = 0;
+
+    /* Resident fields belong to one timestep and level */
+    if (strcmp(pf->resident_dir, pf->plotfile_dir) != 0 ||
+        pf->resident_level != pf->current_level) {
+        free_resident_fields(pf);
+        memcpy(pf->resident_dir, pf->plotfile_dir, MAX_PATH);
+        pf->resident_level = pf->current_level;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        n_missing = 0;
+        for (int v = 0; v < n_vars; v++) {
+            if (vars[v] < 0 || resident_field(pf, vars[v])) continue;
+            int dup = 0;
+            for (int m = 0; m < n_missing; m++) {
+                if (missing[m] == vars[v]) dup = 1;
+            }
+            if (!dup && n_missing < MAX_RESIDENT_FIELDS) missing[n_missing++] = vars[v];
+        }
+        if (pass == 0 && n_missing > 0 &&
+            ooc_over_budget(pf, pf->n_resident + n_missing, "Overlay")) {
+            return -1;
+        }
+        if (pf->n_resident + n_missing <= MAX_RESIDENT_FIELDS) break;
+        free_resident_fields(pf);  /* Make room, then recount */
+    }
+    if (n_missing == 0) return 0;
+
+    /* Ascending components keep each box a forward read */
+    for (int a = 1; a < n_missing; a++) {
+        int v = missing[a], b = a - 1;
+        while (b >= 0 && missing[b] > v) {
+            missing[b + 1] = missing[b];
+            b--;
+        }
+        missing[b + 1] = v;
+    }
+
+    size_t total_size = (size_t)pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2];
+    void *dests[MAX_RESIDENT_FIELDS];
+    for (int m = 0; m < n_missing; m++) {
+        dests[m] = calloc(total_size, FIELD_ELEM_SIZE);
+        if (!dests[m]) {
+            fprintf(stderr, "Error: Cannot allocate memory for %s\n", pf->variables[missing[m]]);
+            while (m-- > 0) free(dests[m]);
+            return -1;
+        }
+    }
+
+    char level_dir[MAX_PATH];
+    double t0 = wall_seconds();
+    if (level_dir_path(level_dir, pf->plotfile_dir, pf->current_level) < 0 ||
+        read_fab_components(level_dir, pf->boxes, pf->n_boxes, missing, dests, n_missing,
+                            pf->grid_dims, pf->level_lo) < 0) {
+        fprintf(stderr, "Error: Cannot read resident fields from %s\n", pf->plotfile_dir);
+        for (int m = 0; m < n_missing; m++) free(dests[m]);
+        return -1;
+    }
+    double dt = wall_seconds() - t0;
+
+    for (int m = 0; m < n_missing; m++) {
+        pf->resident_var[pf->n_resident] = missing[m];
+        pf->resident_data[pf->n_resident] = dests[m];
+        pf->n_resident++;
+    }
+    double mb = fab_component_mb(pf->boxes, pf->n_boxes) * n_missing;
+    printf("Loaded %d resident field%s in one pass (%.1f MB in %.3f s, %.1f MB/s)\n",
+           n_missing, n_missing > 1 ? "s" : "", mb, dt, dt > 0 ? mb / dt : 0.0);
+    return 0;
+}
+
+/* Headless comparison of the stdio, mmap and io_uring FAB readers on one plotfile.
+ * Every variable of level 0 is read with each backend; the first pass only
+ * warms the page cache so every backend sees the same file cache state. */
+int run_io_benchmark(const char *plotfile_dir) {
+    PlotfileData *pf = (PlotfileData *)calloc(1, sizeof(PlotfileData));
+    if (!pf) return -1;
+    strncpy(pf->plotfile_dir, plotfile_dir, MAX_PATH - 1);
+    if (read_header(pf) < 0 || read_cell_h(pf) < 0) {
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+
+    char level_dir[MAX_PATH];
+    if (level_dir_path(level_dir, pf->plotfile_dir, 0) < 0) {
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+    size_t total_size = (size_t)pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2];
+    double *buf = (double *)calloc(total_size, sizeof(double));
+    if (!buf) {
+        fprintf(stderr, "Error: Cannot allocate benchmark buffer\n");
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+    double mb = (double)total_size * sizeof(double) * pf->n_vars / (1024.0 * 1024.0);
+
+    const char *names[5] = {"warm-up (stdio)", "stdio", "mmap (first map)", "mmap (mapped)",
+                            "io_uring"};
+    int backends[5] = {IO_BACKEND_STDIO, IO_BACKEND_STDIO, IO_BACKEND_MMAP, IO_BACKEND_MMAP,
+                       IO_BACKEND_URING};
+    int saved_backend = io_backend;
+    int result = 0;
+
+    printf("\nI/O benchmark: %d x %d x %d, %d variables, %.1f MB per pass, %d I/O threads, "
+           "io_uring depth %d\n", pf->grid_dims[0], pf->grid_dims[1], pf->grid_dims[2],
+           pf->n_vars, mb, io_threads, io_depth);
+    release_mapped_files();
+    for (int pass = 0; pass < 5; pass++) {
+        /* Without io_uring the reads would fall back to stdio and be timed
+         * under the wrong name */
+        if (backends[pass] == IO_BACKEND_URING && !uring_available()) {
+            printf("  %-18s unavailable, skipped\n", names[pass]);
+            continue;
+        }
+        io_backend = backends[pass];
+        int failed = 0;
+        double t0 = wall_seconds();
+        for (int v = 0; v < pf->n_vars; v++) {
+            if (read_fab_component(level_dir, pf->boxes, pf->n_boxes, v,
+                                   buf, pf->grid_dims, pf->level_lo) < 0) failed = 1;
+        }
+        double dt = wall_seconds() - t0;
+        if (failed) {
+            printf("  %-18s read failed\n", names[pass]);
+            result = -1;
+            continue;
+        }
+        printf("  %-18s %8.3f s  %9.1f MB/s\n", names[pass], dt, dt > 0 ? mb / dt : 0.0);
+    }
+    io_backend = saved_backend;
+
+    release_mapped_files();
+    free(buf);
+    free_plotfile_metadata(pf);
+    free(pf);
+    return result;
+}
+
+/* Running comparison of one --check-io row: values checked, values that
+ * differ, and the first difference */
+typedef struct {
+    size_t n;
+    size_t n_bad;
+    size_t first;
+    double want, got;
+} IoCheck;
+
+/* Compare one value bit for bit, so NaNs match themselves */
+static void io_check_value(IoCheck *c, double want, double got) {
+    if (memcmp(&want, &got, sizeof(double)) != 0) {
+        if (c->n_bad++ == 0) {
+            c->first = c->n;
+            c->want = want;
+            c->got = got;
+        }
+    }
+    c->n++;
+}
+
+/* Print one --check-io row. Returns -1 when any value differed. */
+static int io_check_report(const char *name, const IoCheck *c) {
+    if (c->n_bad == 0) {
+        printf("  %-24s OK (%zu values)\n", name, c->n);
+        return 0;
+    }
+    printf("  %-24s MISMATCH: %zu of %zu values differ, first at value %zu: expected %.17g, read %.17g\n",
+           name, c->n_bad, c->n, c->first, c->want, c->got);
+    return -1;
+}
+
+/* --check-io: the box layout of every level in the run index against a
+ * fresh parse of its Cell_H. Entries whose Header has changed are stale by
+ * design and skipped. */
+static int check_run_index(const PlotfileData *pf) {
+    char run_dir[MAX_PATH], name[MAX_PATH], prefix[64], path[MAX_PATH];
+    RunIndexEntry *entries;
+    int64_t dir_mtime;
+    int n_entries;
+
+    split_plotfile_path(pf->plotfile_dir, run_dir, name);
+    size_t len = strlen(name);
+    while (len > 0 && isdigit((unsigned char)name[len - 1])) len--;
+    if (len >= sizeof(prefix)) len = sizeof(prefix) - 1;
+    memcpy(prefix, name, len);
+    prefix[len] = '\0';
+    if (load_run_index(run_dir, prefix, &dir_mtime, &entries, &n_entries) < 0) {
+        printf("  %-24s not present, skipped\n", "run index");
+        return 0;
+    }
+
+    const RunIndexEntry *e = NULL;
+    for (int i = 0; i < n_entries && !e; i++) {
+        if (strcmp(entries[i].name, name) == 0) e = &entries[i];
+    }
+    int result = 0;
+    if (!e || e->mtime_ns != header_mtime_ns(pf->plotfile_dir)) {
+        printf("  %-24s no current entry, skipped\n", "run index");
+    } else {
+        IoCheck c = {0};
+        Box *boxes = NULL;
+        RangeIndex ri = {0};
+        int capacity = 0, n_boxes = 0;
+        for (int l = 0; l < MAX_LEVELS && result == 0; l++) {
+            const RunIndexLevel *lev = &e->levels[l];
+            if (lev->n_boxes < 0) continue;
+            if (snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", pf->plotfile_dir, l) >= MAX_PATH ||
+                parse_cell_h(path, pf->ndim, &boxes, &capacity, &n_boxes, &ri) < 0) {
+                result = -1;
+                break;
+            }
+            io_check_value(&c, n_boxes, lev->n_boxes);
+            for (int b = 0; b < n_boxes && b < lev->n_boxes; b++) {
+                for (int d = 0; d < 3; d++) {
+                    io_check_value(&c, boxes[b].lo[d], lev->boxes[b].lo[d]);
+                    io_check_value(&c, boxes[b].hi[d], lev->boxes[b].hi[d]);
+                }
+                io_check_value(&c, boxes[b].offset, lev->boxes[b].offset);
+                io_check_value(&c, 0, strcmp(boxes[b].filename, lev->boxes[b].filename) != 0);
+            }
+            io_check_value(&c, ri.n_tables == 2 ? ri.n_boxes * ri.n_comps : 0,
+                           lev->ranges.n_tables == 2 ? lev->ranges.n_boxes * lev->ranges.n_comps : 0);
+            if (ri.n_tables == 2 && lev->ranges.n_tables == 2 && ri.n_boxes == lev->ranges.n_boxes &&
+                ri.n_comps == lev->ranges.n_comps) {
+                for (size_t i = 0; i < (size_t)ri.n_boxes * ri.n_comps; i++) {
+                    io_check_value(&c, ri.min[i], lev->ranges.min[i]);
+                    io_check_value(&c, ri.max[i], lev->ranges.max[i]);
+                }
+            }
+        }
+        if (result < 0) {
+            printf("  %-24s Cell_H unreadable\n", "run index");
+        } else {
+            result = io_check_report("run index", &c);
+        }
+        free(boxes);
+        free_range_index(&ri);
+    }
+    for (int i = 0; i < n_entries; i++) free_run_index_entry(&entries[i]);
+    free(entries);
+    return result;
+}
+
+/* --check-io: the per-layer moments stored for var_idx of level 0 against
+ * those of ref. They may have been computed from --float32 fields or by
+ * out-of-core streaming, so they only need to agree to the last few digits. */
+static int check_stats_file(const PlotfileData *pf, int var_idx, const double *ref,
+                            const char *name) {
+    const int *dims = pf->grid_dims;
+    int n_stored = 0, n_bad = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        if (!stats_cache_lookup(pf->plotfile_dir, 0, pf->variables[var_idx], axis)) continue;
+        double *moments = (double *)malloc((size_t)dims[axis] * STATS_MOMENTS * sizeof(double));
+        if (!moments || field_layer_moments(ref, dims, axis, moments) < 0) {
+            free(moments);
+            continue;
+        }
+        for (int s = 0; s < dims[axis]; s++) {
+            double m[STATS_MOMENTS];
+            const double *want = &moments[(size_t)s * STATS_MOMENTS];
+            if (stats_cache_layer(pf->plotfile_dir, 0, pf->variables[var_idx], axis, s, m) < 0) {
+                continue;
+            }
+            double scale = fabs(want[0]) + want[1];
+            int bad = fabs(m[0] - want[0]) > 1e-5 * scale || fabs(m[1] - want[1]) > 1e-5 * scale ||
+                      fabs(m[2] - want[2]) > 1e-3 * (1.0 + fabs(want[2]));
+            if (bad && n_bad++ == 0) {
+                printf("  %-24s %c=%d stored %.9g %.9g %.9g, computed %.9g %.9g %.9g\n",
+                       name, "XYZ"[axis], s, m[0], m[1], m[2], want[0], want[1], want[2]);
+            }
+            n_stored++;
+        }
+        free(moments);
+    }
+    if (n_stored == 0) {
+        printf("  %-24s not present, skipped\n", name);
+        return 0;
+    }
+    if (n_bad > 0) {
+        printf("  %-24s MISMATCH: %d of %d stored layers differ\n", name, n_bad, n_stored);
+        return -1;
+    }
+    printf("  %-24s OK (%d layers)\n", name, n_stored);
+    return 0;
+}
+
+/* --check-io: every way pltview loads variable var_idx of level 0, against
+ * ref, a single-threaded stdio read. plane and ref_plane hold any plane. */
+static int check_variable_reads(PlotfileData *pf, int var_idx, const char *level_dir,
+                                const double *ref, double *test, double *plane,
+                                double *ref_plane) {
+    const int *dims = pf->grid_dims;
+    size_t total_size = (size_t)dims[0] * dims[1] * dims[2];
+    int saved_threads = io_threads;
+    int threads = io_threads > 1 ? io_threads : 4;
+    char name[64];
+    int result = 0;
+
+    /* Whole-field readers */
+    const char *names[3] = {"stdio", "mmap", "io_uring"};
+    int backends[3] = {IO_BACKEND_STDIO, IO_BACKEND_MMAP, IO_BACKEND_URING};
+    for (int r = 0; r < 3; r++) {
+        if (backends[r] == IO_BACKEND_URING && !uring_available()) {
+            printf("  %-24s unavailable, skipped\n", names[r]);
+            continue;
+        }
+        io_backend = backends[r];
+        io_threads = threads;
+        snprintf(name, sizeof(name), "%s, %d threads", names[r], threads);
+        memset(test, 0, total_size * sizeof(double));
+        int n_read = read_fab_component(level_dir, pf->boxes, pf->n_boxes, var_idx, test,
+                                        dims, pf->level_lo);
+        io_threads = saved_threads;
+        if (n_read < 0) {
+            printf("  %-24s read failed\n", name);
+            result = -1;
+            continue;
+        }
+        IoCheck c = {0};
+        for (size_t i = 0; i < total_size; i++) io_check_value(&c, ref[i], test[i]);
+        if (io_check_report(name, &c) < 0) result = -1;
+    }
+    io_backend = IO_BACKEND_STDIO;
+
+    /* --float32 storage narrows on read */
+    field_float32 = 1;
+    memset(test, 0, total_size * sizeof(float));
+    int n_read = read_fab_component(level_dir, pf->boxes, pf->n_boxes, var_idx, test,
+                                    dims, pf->level_lo);
+    field_float32 = 0;
+    if (n_read < 0) {
+        printf("  %-24s read failed\n", "float32 storage");
+        result = -1;
+    } else {
+        IoCheck c = {0};
+        const float *narrow = (const float *)test;
+        for (size_t i = 0; i < total_size; i++) io_check_value(&c, (float)ref[i], narrow[i]);
+        if (io_check_report("float32 storage", &c) < 0) result = -1;
+    }
+
+    /* Slice mode: every Z plane, and the first, middle and last X and Y planes */
+    IoCheck c = {0};
+    int failed = 0;
+    for (int axis = 0; axis < 3 && !failed; axis++) {
+        int step = (axis == 2 || dims[axis] < 3) ? 1 : (dims[axis] - 1) / 2;
+        size_t n = (size_t)((axis == 0) ? dims[1] : dims[0]) * ((axis == 2) ? dims[1] : dims[2]);
+        for (int idx = 0; idx < dims[axis] && !failed; idx += step) {
+            if (read_fab_plane(level_dir, pf->boxes, pf->n_boxes, var_idx, axis, idx, plane,
+                               dims, pf->level_lo) < 0) {
+                failed = 1;
+                break;
+            }
+            extract_field_plane(ref, dims, ref_plane, axis, idx);
+            for (size_t i = 0; i < n; i++) io_check_value(&c, ref_plane[i], plane[i]);
+        }
+    }
+    if (failed) {
+        printf("  %-24s read failed\n", "slice planes");
+        result = -1;
+    } else if (io_check_report("slice planes", &c) < 0) {
+        result = -1;
+    }
+
+    /* Out-of-core: a budget of about one field, so the walk reads several
+     * chunks of growing depth and evicts along the way */
+    int saved_ooc = ooc_mb;
+    ooc_mb = (int)(total_size * sizeof(double) / (1024 * 1024));
+    if (ooc_mb < 1) ooc_mb = 1;
+    memset(&c, 0, sizeof(c));
+    failed = 0;
+    for (int z = 0; z < dims[2];) {
+        const OocChunk *oc = ooc_chunk(pf, var_idx, z);
+        if (!oc) {
+            failed = 1;
+            break;
+        }
+        size_t base = (size_t)oc->z0 * dims[0] * dims[1];
+        size_t n = (size_t)oc->dims[0] * oc->dims[1] * oc->dims[2];
+        for (size_t i = 0; i < n; i++) io_check_value(&c, ref[base + i], field_value(oc->data, i));
+        z = oc->z0 + oc->dims[2];
+    }
+    while (n_ooc_chunks > 0) ooc_evict_lru();
+    ooc_mb = saved_ooc;
+    if (failed) {
+        printf("  %-24s read failed\n", "out-of-core chunks");
+        result = -1;
+    } else if (io_check_report("out-of-core chunks", &c) < 0) {
+        result = -1;
+    }
+
+    /* Slice sidecars hold float32 planes */
+    memset(&c, 0, sizeof(c));
+    for (int axis = 0; axis < 3; axis++) {
+        size_t n = (size_t)((axis == 0) ? dims[1] : dims[0]) * ((axis == 2) ? dims[1] : dims[2]);
+        for (int idx = 0; idx < dims[axis]; idx++) {
+            if (slice_cache_read(pf, var_idx, axis, idx, plane) < 0) continue;
+            extract_field_plane(ref, dims, ref_plane, axis, idx);
+            for (size_t i = 0; i < n; i++) io_check_value(&c, (float)ref_plane[i], plane[i]);
+        }
     }
-
-    printf("Level %d: Found %d boxes, Grid: %d x %d x %d (lo: %d,%d,%d)\n",
-           pf->current_level, pf->n_boxes,
-           pf->grid_dims[0], pf->grid_dims[1], pf->grid_dims[2],
-           pf->level_lo[0], pf->level_lo[1], pf->level_lo[2]);
-    return 0;
-}
-
-/* Read variable data from all boxes */
-int read_variable_data(PlotfileData *pf, int var_idx) {
-    char path[MAX_PATH];
-    FILE *fp;
-    int box_idx, i, j, k;
-    size_t total_size = pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2];
-    
-    /* Allocate data array (Z, Y, X ordering) */
-    if (pf->data) free(pf->data);
-    pf->data = (double *)calloc(total_size, sizeof(double));
-    
-    /* Read each box */
-    for (box_idx = 0; box_idx < pf->n_boxes; box_idx++) {
-        Box *box = &pf->boxes[box_idx];
-        int box_dims[3];
-        for (i = 0; i < 3; i++) {
-            box_dims[i] = box->hi[i] - box->lo[i] + 1;
+    if (c.n == 0) {
+        printf("  %-24s not present, skipped\n", "slice sidecar");
+    } else if (io_check_report("slice sidecar", &c) < 0) {
+        result = -1;
+    }
+
+    /* Statistics files, the plotfile's own and its run's, which is found
+     * through the installed run directory */
+    if (check_stats_file(pf, var_idx, ref, "statistics, plotfile") < 0) result = -1;
+    char saved_dir[MAX_PATH], run_dir[MAX_PATH], base[MAX_PATH];
+    split_plotfile_path(pf->plotfile_dir, run_dir, base);
+    if (strncmp(pf->plotfile_dir, run_dir, strlen(run_dir)) == 0) {
+        memcpy(saved_dir, run_index_dir, MAX_PATH);
+        memcpy(run_index_dir, run_dir, MAX_PATH);
+        if (check_stats_file(pf, var_idx, ref, "statistics, run") < 0) result = -1;
+        memcpy(run_index_dir, saved_dir, MAX_PATH);
+    }
+    return result;
+}
+
+/* --check-io: the packed per-box layout of each refined level, read with
+ * every backend, against a dense stdio read of the level */
+static int check_level_reads(PlotfileData *pf, int var_idx) {
+    char level_dir[MAX_PATH], name[64];
+    int result = 0;
+
+    for (int level = 1; level < pf->n_levels && level < MAX_LEVELS; level++) {
+        LevelData *ld = &pf->levels[level];
+        if (!ld->box_offset) continue;
+        size_t dense_size = (size_t)ld->grid_dims[0] * ld->grid_dims[1] * ld->grid_dims[2];
+        size_t packed_size = ld->box_offset[ld->n_boxes];
+        double *dense = (double *)calloc(dense_size > 0 ? dense_size : 1, sizeof(double));
+        double *packed = (double *)malloc((packed_size > 0 ? packed_size : 1) * sizeof(double));
+        io_backend = IO_BACKEND_STDIO;
+        if (!dense || !packed || level_dir_path(level_dir, pf->plotfile_dir, level) < 0 ||
+            read_fab_component(level_dir, ld->boxes, ld->n_boxes, var_idx, dense,
+                               ld->grid_dims, ld->level_lo) < 0) {
+            printf("  Level %d %-14s read failed\n", level, "dense");
+            free(dense);
+            free(packed);
+            result = -1;
+            continue;
         }
-        size_t box_size = box_dims[0] * box_dims[1] * box_dims[2];
-        
-        snprintf(path, MAX_PATH, "%s/Level_%d/%s", pf->plotfile_dir, pf->current_level, box->filename);
-        fp = fopen(path, "rb");
-        if (!fp) continue;
-        
-        /* Skip FAB header (read until newline) */
-        int c;
-        while ((c = fgetc(fp)) != EOF && c != '\n');
-        
-        /* Skip to variable data */
-        fseek(fp, var_idx * box_size * sizeof(double), SEEK_CUR);
-        
-        /* Read box data */
-        double *box_data = (double *)malloc(box_size * sizeof(double));
-        fread(box_data, sizeof(double), box_size, fp);
-        fclose(fp);
-        
-        /* Insert into global array (Fortran order -> C order) */
-        /* Fortran order: X varies fastest */
-        /* Use relative indices by subtracting level_lo to handle non-zero level origins */
-        size_t idx = 0;
-        for (k = 0; k < box_dims[2]; k++) {
-            for (j = 0; j < box_dims[1]; j++) {
-                for (i = 0; i < box_dims[0]; i++) {
-                    int gx = box->lo[0] + i - pf->level_lo[0];
-                    int gy = box->lo[1] + j - pf->level_lo[1];
-                    int gz = box->lo[2] + k - pf->level_lo[2];
-                    /* Global array: data[z][y][x] */
-                    size_t gidx = gz * pf->grid_dims[1] * pf->grid_dims[0] +
-                                  gy * pf->grid_dims[0] + gx;
-                    pf->data[gidx] = box_data[idx++];
+
+        const char *names[3] = {"stdio", "mmap", "io_uring"};
+        int backends[3] = {IO_BACKEND_STDIO, IO_BACKEND_MMAP, IO_BACKEND_URING};
+        for (int r = 0; r < 3; r++) {
+            snprintf(name, sizeof(name), "Level %d packed, %s", level, names[r]);
+            if (backends[r] == IO_BACKEND_URING && !uring_available()) {
+                printf("  %-24s unavailable, skipped\n", name);
+                continue;
+            }
+            io_backend = backends[r];
+            memset(packed, 0, packed_size * sizeof(double));
+            if (read_fab_component_packed(level_dir, ld->boxes, ld->n_boxes, var_idx, packed,
+                                          ld->box_offset) < 0) {
+                printf("  %-24s read failed\n", name);
+                result = -1;
+                continue;
+            }
+            IoCheck c = {0};
+            for (int b = 0; b < ld->n_boxes; b++) {
+                const Box *box = &ld->boxes[b];
+                const double *cell = &packed[ld->box_offset[b]];
+                for (int k = box->lo[2]; k <= box->hi[2]; k++) {
+                    for (int j = box->lo[1]; j <= box->hi[1]; j++) {
+                        for (int i = box->lo[0]; i <= box->hi[0]; i++) {
+                            size_t idx = ((size_t)(k - ld->level_lo[2]) * ld->grid_dims[1] +
+                                          (j - ld->level_lo[1])) * ld->grid_dims[0] +
+                                         (i - ld->level_lo[0]);
+                            io_check_value(&c, dense[idx], *cell++);
+                        }
+                    }
                 }
             }
+            if (io_check_report(name, &c) < 0) result = -1;
         }
-        
-        free(box_data);
+        free(dense);
+        free(packed);
+    }
+    io_backend = IO_BACKEND_STDIO;
+    return result;
+}
+
+/* Headless self-check (--check-io): load one variable of a plotfile, or
+ * every variable, with each reader and each storage layout, and compare
+ * the results element by element against a single-threaded stdio read of
+ * level 0. Sidecars, cached statistics and the run index are checked when
+ * present. Returns -1 when anything differs or cannot be read. */
+int run_io_check(const char *plotfile_dir, const char *variable) {
+    PlotfileData *pf = (PlotfileData *)calloc(1, sizeof(PlotfileData));
+    if (!pf) return -1;
+    strncpy(pf->plotfile_dir, plotfile_dir, MAX_PATH - 1);
+    if (read_header(pf) < 0 || read_cell_h(pf) < 0) {
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
     }
-    
-    printf("Loaded variable: %s\n", pf->variables[var_idx]);
-    return 0;
+
+    int first_var = 0, last_var = pf->n_vars - 1;
+    if (variable) {
+        for (first_var = 0; first_var < pf->n_vars; first_var++) {
+            if (strcmp(pf->variables[first_var], variable) == 0) break;
+        }
+        if (first_var == pf->n_vars) {
+            fprintf(stderr, "Error: No variable '%s' in %s\n", variable, plotfile_dir);
+            free_plotfile_metadata(pf);
+            free(pf);
+            return -1;
+        }
+        last_var = first_var;
+    }
+
+    const int *dims = pf->grid_dims;
+    size_t total_size = (size_t)dims[0] * dims[1] * dims[2];
+    size_t plane_size = (size_t)dims[0] * dims[1];
+    if ((size_t)dims[1] * dims[2] > plane_size) plane_size = (size_t)dims[1] * dims[2];
+    if ((size_t)dims[0] * dims[2] > plane_size) plane_size = (size_t)dims[0] * dims[2];
+    char level_dir[MAX_PATH];
+    double *ref = (double *)calloc(total_size > 0 ? total_size : 1, sizeof(double));
+    double *test = (double *)calloc(total_size > 0 ? total_size : 1, sizeof(double));
+    double *plane = (double *)malloc((plane_size > 0 ? plane_size : 1) * sizeof(double));
+    double *ref_plane = (double *)malloc((plane_size > 0 ? plane_size : 1) * sizeof(double));
+    if (!ref || !test || !plane || !ref_plane ||
+        level_dir_path(level_dir, pf->plotfile_dir, 0) < 0) {
+        fprintf(stderr, "Error: Cannot allocate check buffers\n");
+        free(ref);
+        free(test);
+        free(plane);
+        free(ref_plane);
+        free_plotfile_metadata(pf);
+        free(pf);
+        return -1;
+    }
+
+    int saved_backend = io_backend, saved_threads = io_threads, saved_float32 = field_float32;
+    field_float32 = 0;
+    int result = 0;
+    for (int level = 1; level < pf->n_levels && level < MAX_LEVELS; level++) {
+        if (read_cell_h_level(pf, level) < 0) result = -1;
+    }
+
+    printf("\nI/O check: %d x %d x %d, %d box%s on level 0, %d level%s\n",
+           dims[0], dims[1], dims[2], pf->n_boxes, pf->n_boxes != 1 ? "es" : "",
+           pf->n_levels, pf->n_levels != 1 ? "s" : "");
+    if (check_run_index(pf) < 0) result = -1;
+    for (int v = first_var; v <= last_var; v++) {
+        printf(" %s\n", pf->variables[v]);
+        io_backend = IO_BACKEND_STDIO;
+        io_threads = 1;
+        if (read_fab_component(level_dir, pf->boxes, pf->n_boxes, v, ref, dims,
+                               pf->level_lo) < 0) {
+            io_threads = saved_threads;
+            printf("  %-24s read failed\n", "stdio reference");
+            result = -1;
+            continue;
+        }
+        io_threads = saved_threads;
+        if (check_variable_reads(pf, v, level_dir, ref, test, plane, ref_plane) < 0) result = -1;
+        if (check_level_reads(pf, v) < 0) result = -1;
+    }
+    io_backend = saved_backend;
+    io_threads = saved_threads;
+    field_float32 = saved_float32;
+    printf("%s\n", result < 0 ? "I/O check FAILED" : "I/O check passed");
+
+    release_mapped_files();
+    free(ref);
+    free(test);
+    free(plane);
+    free(ref_plane);
+    free_all_levels(pf);
+    free_plotfile_metadata(pf);
+    free(pf);
+    return result;
 }
 
 /* ========== Multi-Level Overlay Functions ========== */
@@ -1142,75 +5614,24 @@ int read_variable_data(PlotfileData *pf, int var_idx) {
 /* Read Cell_H for a specific level into LevelData */
 int read_cell_h_level(PlotfileData *pf, int level) {
     char path[MAX_PATH];
-    char line[MAX_LINE];
-    FILE *fp;
     int i;
     LevelData *ld = &pf->levels[level];
 
-    snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", pf->plotfile_dir, level);
-    fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot open %s\n", path);
-        return -1;
-    }
-
     /* Reset level data */
     int level_lo[3] = {0, 0, 0};
     int level_hi[3] = {0, 0, 0};
-    int found_domain = 0;
-    ld->n_boxes = 0;
-
-    /* Parse box definitions and FabOnDisk entries */
-    int box_count = 0;
-    while (fgets(line, MAX_LINE, fp)) {
-        if (strncmp(line, "((", 2) == 0) {
-            /* Parse box: ((lo_x,lo_y,lo_z) (hi_x,hi_y,hi_z) ...) */
-            char *p = line + 2;
-            int lo[3], hi[3];
-            for (i = 0; i < pf->ndim; i++) {
-                while (*p && !isdigit(*p) && *p != '-') p++;
-                lo[i] = atoi(p);
-                ld->boxes[box_count].lo[i] = lo[i];
-                while (*p && (isdigit(*p) || *p == '-')) p++;
-            }
-            for (i = 0; i < pf->ndim; i++) {
-                while (*p && !isdigit(*p) && *p != '-') p++;
-                hi[i] = atoi(p);
-                ld->boxes[box_count].hi[i] = hi[i];
-                while (*p && (isdigit(*p) || *p == '-')) p++;
-            }
 
-            /* Track overall domain bounds */
-            if (!found_domain) {
-                for (i = 0; i < pf->ndim; i++) {
-                    level_lo[i] = lo[i];
-                    level_hi[i] = hi[i];
-                }
-                found_domain = 1;
-            } else {
-                for (i = 0; i < pf->ndim; i++) {
-                    if (lo[i] < level_lo[i]) level_lo[i] = lo[i];
-                    if (hi[i] > level_hi[i]) level_hi[i] = hi[i];
-                }
-            }
-            box_count++;
-        } else if (strncmp(line, "FabOnDisk:", 10) == 0) {
-            /* Parse FabOnDisk: Cell_D_XXXXX */
-            char *p = strchr(line, ':');
-            if (p) {
-                p++;
-                while (*p == ' ') p++;
-                char *end = strchr(p, ' ');
-                if (end) *end = '\0';
-                end = strchr(p, '\n');
-                if (end) *end = '\0';
-                strncpy(ld->boxes[ld->n_boxes].filename, p, 63);
-                ld->n_boxes++;
-            }
+    /* Box layout from the run index, or parsed and then indexed */
+    if (run_index_load_level(pf->plotfile_dir, level, &ld->boxes, &ld->box_capacity,
+                             &ld->n_boxes, &ld->ranges) < 0) {
+        snprintf(path, MAX_PATH, "%s/Level_%d/Cell_H", pf->plotfile_dir, level);
+        if (parse_cell_h(path, pf->ndim, &ld->boxes, &ld->box_capacity, &ld->n_boxes,
+                         &ld->ranges) < 0) {
+            return -1;
         }
+        run_index_store_level(pf->plotfile_dir, level, ld->boxes, ld->n_boxes, &ld->ranges);
     }
-
-    fclose(fp);
+    box_bounds(ld->boxes, ld->n_boxes, pf->ndim, level_lo, level_hi);
 
     /* Store level bounds and grid dimensions */
     for (i = 0; i < pf->ndim; i++) {
@@ -1224,6 +5645,24 @@ int read_cell_h_level(PlotfileData *pf, int level) {
         ld->grid_dims[i] = 1;
     }
 
+    build_box_index(&ld->box_index, ld->boxes, ld->n_boxes);
+
+    /* Packed per-box layout: each box's array follows the previous one */
+    size_t *offsets = (size_t *)realloc(ld->box_offset, (ld->n_boxes + 1) * sizeof(size_t));
+    if (!offsets) {
+        fprintf(stderr, "Error: Cannot allocate box offsets for level %d\n", level);
+        return -1;
+    }
+    ld->box_offset = offsets;
+    ld->box_offset[0] = 0;
+    for (i = 0; i < ld->n_boxes; i++) {
+        const Box *box = &ld->boxes[i];
+        ld->box_offset[i + 1] = ld->box_offset[i] +
+                                (size_t)(box->hi[0] - box->lo[0] + 1) *
+                                (box->hi[1] - box->lo[1] + 1) *
+                                (box->hi[2] - box->lo[2] + 1);
+    }
+
     printf("Level %d overlay: Found %d boxes, Grid: %d x %d x %d (lo: %d,%d,%d)\n",
            level, ld->n_boxes,
            ld->grid_dims[0], ld->grid_dims[1], ld->grid_dims[2],
@@ -1231,85 +5670,91 @@ int read_cell_h_level(PlotfileData *pf, int level) {
     return 0;
 }
 
-/* Read variable data for a specific level into LevelData */
+/* Read variable data for a specific level into LevelData. Each box keeps
+ * its own array (packed back to back), so memory follows the refined
+ * volume rather than the level's bounding box. */
 int read_variable_data_level(PlotfileData *pf, int var_idx, int level) {
-    char path[MAX_PATH];
-    FILE *fp;
-    int box_idx, i, j, k;
+    char level_dir[MAX_PATH];
     LevelData *ld = &pf->levels[level];
 
-    size_t total_size = (size_t)ld->grid_dims[0] * ld->grid_dims[1] * ld->grid_dims[2];
+    size_t total_size = ld->box_offset ? ld->box_offset[ld->n_boxes] : 0;
+
+    /* Serve from the field cache when this field was read before */
+    void *cached = field_cache_acquire(pf->plotfile_dir, PACKED_LEVEL_KEY(level), var_idx);
+    field_cache_release(ld->data);
+    ld->data = cached;
+    if (ld->data) {
+        ld->loaded = 1;
+        printf("Cached level %d: %s\n", level, pf->variables[var_idx]);
+        return 0;
+    }
 
     /* Allocate data array */
-    if (ld->data) free(ld->data);
-    ld->data = (double *)calloc(total_size, sizeof(double));
+    ld->data = calloc(total_size > 0 ? total_size : 1, FIELD_ELEM_SIZE);
     if (!ld->data) {
         fprintf(stderr, "Error: Cannot allocate memory for level %d\n", level);
         return -1;
     }
 
-    /* Read each box */
-    for (box_idx = 0; box_idx < ld->n_boxes; box_idx++) {
-        Box *box = &ld->boxes[box_idx];
-        int box_dims[3];
-        for (i = 0; i < 3; i++) {
-            box_dims[i] = box->hi[i] - box->lo[i] + 1;
-        }
-        size_t box_size = box_dims[0] * box_dims[1] * box_dims[2];
-
-        snprintf(path, MAX_PATH, "%s/Level_%d/%s", pf->plotfile_dir, level, box->filename);
-        fp = fopen(path, "rb");
-        if (!fp) continue;
-
-        /* Skip FAB header */
-        int c;
-        while ((c = fgetc(fp)) != EOF && c != '\n');
-
-        /* Skip to variable data */
-        fseek(fp, var_idx * box_size * sizeof(double), SEEK_CUR);
-
-        /* Read box data */
-        double *box_data = (double *)malloc(box_size * sizeof(double));
-        fread(box_data, sizeof(double), box_size, fp);
-        fclose(fp);
-
-        /* Insert into level array using relative indices */
-        size_t idx = 0;
-        for (k = 0; k < box_dims[2]; k++) {
-            for (j = 0; j < box_dims[1]; j++) {
-                for (i = 0; i < box_dims[0]; i++) {
-                    int gx = box->lo[0] + i - ld->level_lo[0];
-                    int gy = box->lo[1] + j - ld->level_lo[1];
-                    int gz = box->lo[2] + k - ld->level_lo[2];
-                    size_t gidx = gz * ld->grid_dims[1] * ld->grid_dims[0] +
-                                  gy * ld->grid_dims[0] + gx;
-                    ld->data[gidx] = box_data[idx++];
-                }
-            }
-        }
-
-        free(box_data);
+    /* Read each box into its own array */
+    double t0 = wall_seconds();
+    if (level_dir_path(level_dir, pf->plotfile_dir, level) < 0 ||
+        read_fab_component_packed(level_dir, ld->boxes, ld->n_boxes, var_idx,
+                                  ld->data, ld->box_offset) < 0) {
+        fprintf(stderr, "Error: Cannot read %s on level %d from %s\n",
+                pf->variables[var_idx], level, pf->plotfile_dir);
+        free(ld->data);
+        ld->data = NULL;
+        ld->loaded = 0;
+        return -1;
     }
+    double dt = wall_seconds() - t0;
+    double mb = fab_component_mb(ld->boxes, ld->n_boxes);
+    field_cache_insert(pf->plotfile_dir, PACKED_LEVEL_KEY(level), var_idx, ld->data,
+                       total_size * FIELD_ELEM_SIZE);
 
     ld->loaded = 1;
-    printf("Loaded level %d: %s\n", level, pf->variables[var_idx]);
+    printf("Loaded level %d: %s (%.1f MB in %.3f s, %.1f MB/s)\n",
+           level, pf->variables[var_idx], mb, dt, dt > 0 ? mb / dt : 0.0);
     return 0;
 }
 
-/* Load all levels for overlay rendering */
+/* Load all levels for overlay rendering. In out-of-core mode the levels
+ * share the budget with the Z chunks: chunks are evicted to make room, and
+ * a level that still does not fit is left out of the overlay. */
 int load_all_levels(PlotfileData *pf, int var_idx) {
     int level;
     int loaded_count = 0;
+    size_t budget = (size_t)ooc_mb * 1024 * 1024;
 
     printf("load_all_levels: Loading %d levels for var %d\n", pf->n_levels, var_idx);
 
+    ooc_level_bytes = 0;
     for (level = 0; level < pf->n_levels && level < MAX_LEVELS; level++) {
+        LevelData *ld = &pf->levels[level];
+
         /* Always read Cell_H for this level to ensure fresh data */
         if (read_cell_h_level(pf, level) < 0) {
             fprintf(stderr, "Warning: Cannot read Cell_H for level %d\n", level);
             continue;
         }
 
+        if (ooc_mb > 0) {
+            size_t bytes = (ld->box_offset ? ld->box_offset[ld->n_boxes] : 0) * FIELD_ELEM_SIZE;
+            while (n_ooc_chunks > 0 && ooc_level_bytes + ooc_bytes + bytes > budget) {
+                ooc_evict_lru();
+            }
+            if (ooc_level_bytes + bytes > budget) {
+                fprintf(stderr, "Overlay level %d needs %.0f MB, over the --out-of-core budget of %d MB\n",
+                        level, (ooc_level_bytes + bytes) / (1024.0 * 1024.0), ooc_mb);
+                field_cache_release(ld->data);
+                ld->data = NULL;
+                ld->loaded = 0;
+                continue;
+            }
+            ooc_level_bytes += bytes;
+        }
+
         /* Read variable data for this level */
         if (read_variable_data_level(pf, var_idx, level) < 0) {
             fprintf(stderr, "Warning: Cannot load variable for level %d\n", level);
@@ -1326,13 +5771,22 @@ int load_all_levels(PlotfileData *pf, int var_idx) {
 /* Free all level data */
 void free_all_levels(PlotfileData *pf) {
     int level, i;
+    ooc_level_bytes = 0;
     for (level = 0; level < MAX_LEVELS; level++) {
         if (pf->levels[level].data) {
-            free(pf->levels[level].data);
+            /* The field stays in the cache for when overlay comes back */
+            field_cache_release(pf->levels[level].data);
             pf->levels[level].data = NULL;
         }
         pf->levels[level].loaded = 0;
+        free(pf->levels[level].boxes);
+        pf->levels[level].boxes = NULL;
+        free(pf->levels[level].box_offset);
+        pf->levels[level].box_offset = NULL;
         pf->levels[level].n_boxes = 0;
+        pf->levels[level].box_capacity = 0;
+        free_range_index(&pf->levels[level].ranges);
+        free_box_index(&pf->levels[level].box_index);
         /* Clear all fields to prevent stale data issues */
         for (i = 0; i < 3; i++) {
             pf->levels[level].grid_dims[i] = 0;
@@ -1407,9 +5861,23 @@ int read_sdm_header(ParticleData *pd, const char *plotfile_dir) {
     /* Number of grids at level 0 */
     fgets(line, MAX_LINE, fp);
     pd->n_grids = atoi(line);
+    if (pd->n_grids < 0) pd->n_grids = 0;
 
     /* Per-grid info: file_number count offset */
-    for (int i = 0; i < pd->n_grids && i < MAX_BOXES; i++) {
+    size_t n_alloc = pd->n_grids > 0 ? pd->n_grids : 1;
+    int *file_num = (int *)realloc(pd->grid_file_num, n_alloc * sizeof(int));
+    if (file_num) pd->grid_file_num = file_num;
+    int *count = (int *)realloc(pd->grid_count, n_alloc * sizeof(int));
+    if (count) pd->grid_count = count;
+    long *offset = (long *)realloc(pd->grid_offset, n_alloc * sizeof(long));
+    if (offset) pd->grid_offset = offset;
+    if (!file_num || !count || !offset) {
+        fprintf(stderr, "Error: Cannot allocate grid table for %d grids\n", pd->n_grids);
+        pd->n_grids = 0;
+        fclose(fp);
+        return -1;
+    }
+    for (int i = 0; i < pd->n_grids; i++) {
         fgets(line, MAX_LINE, fp);
         sscanf(line, "%d %d %ld", &pd->grid_file_num[i],
                &pd->grid_count[i], &pd->grid_offset[i]);
@@ -1495,6 +5963,140 @@ double compute_domain_volume(const char *plotfile_dir) {
     return volume;
 }
 
+/* Copy radius, multiplicity and mass of one grid's particles out of its real
+ * block, starting at output index first */
+static void unpack_grid_particles(ParticleData *pd, int g, int first,
+                                  const double *real_buf, size_t read_count) {
+    int count = pd->grid_count[g];
+    int reals_per_particle = pd->ndim + pd->n_real_comps;  /* x,y,z + real comps */
+
+    if (read_count != (size_t)count * reals_per_particle) {
+        fprintf(stderr, "Warning: Short read for grid %d: got %zu expected %d\n",
+                g, read_count, count * reals_per_particle);
+    }
+
+    /* Indices within the real block (0-based, including x,y,z) */
+    int real_radius_idx = pd->ndim + pd->radius_idx;
+    int real_mult_idx = pd->ndim + pd->mult_idx;
+    int real_mass_idx = pd->ndim + pd->mass_idx;
+
+    int complete = (int)(read_count / reals_per_particle);
+    for (int p = 0; p < complete && p < count && (first + p) < pd->n_particles; p++) {
+        const double *pdata = real_buf + (size_t)p * reals_per_particle;
+        pd->radius[first + p] = pdata[real_radius_idx];
+        pd->multiplicity[first + p] = pdata[real_mult_idx];
+        pd->mass[first + p] = pdata[real_mass_idx];
+    }
+}
+
+/* One grid's real block in an io_uring particle load */
+typedef struct {
+    int file_num;
+    long offset;
+    int grid;
+} SdmGridRead;
+
+/* Read order for grid blocks: by DATA file, then by offset */
+static int compare_sdm_grid_reads(const void *a, const void *b) {
+    const SdmGridRead *ra = (const SdmGridRead *)a;
+    const SdmGridRead *rb = (const SdmGridRead *)b;
+    if (ra->file_num != rb->file_num) return (ra->file_num > rb->file_num) - (ra->file_num < rb->file_num);
+    return (ra->offset > rb->offset) - (ra->offset < rb->offset);
+}
+
+/* Grid reads of one io_uring particle load, in plan order */
+typedef struct {
+    ParticleData *pd;
+    SdmGridRead *reads;
+    int *fds;                  /* DATA file descriptor of each planned read */
+    int *first;                /* Output index of each grid's first particle */
+} UringSdmLoad;
+
+/* Each grid's real block follows its int block */
+static int uring_prep_sdm_grid(void *ctx, int n, int *fd, size_t *len, off_t *off) {
+    UringSdmLoad *load = (UringSdmLoad *)ctx;
+    ParticleData *pd = load->pd;
+    int g = load->reads[n].grid;
+    int count = pd->grid_count[g];
+    *fd = load->fds[n];
+    *off = pd->grid_offset[g] + (off_t)count * (2 + pd->n_int_comps) * sizeof(int);
+    *len = (size_t)count * (pd->ndim + pd->n_real_comps) * sizeof(double);
+    return 0;
+}
+
+static void uring_done_sdm_grid(void *ctx, int n, const char *buf, size_t got) {
+    UringSdmLoad *load = (UringSdmLoad *)ctx;
+    int g = load->reads[n].grid;
+    unpack_grid_particles(load->pd, g, load->first[g], (const double *)buf, got / sizeof(double));
+}
+
+/* io_uring path of read_sdm_data: every grid's real block is queued at
+ * once, io_depth reads in flight, grouped by DATA file and in offset
+ * order. Returns -1 when io_uring is unavailable. */
+static int read_sdm_grids_uring(ParticleData *pd, const char *plotfile_dir) {
+    size_t alloc = pd->n_grids > 0 ? pd->n_grids : 1;
+    UringSdmLoad load = {pd, NULL, NULL, NULL};
+    size_t max_len = 0;
+    int n_reads = 0;
+
+    load.reads = (SdmGridRead *)malloc(alloc * sizeof(SdmGridRead));
+    load.fds = (int *)malloc(alloc * sizeof(int));
+    load.first = (int *)malloc(alloc * sizeof(int));
+    if (!load.reads || !load.fds || !load.first) {
+        free(load.reads);
+        free(load.fds);
+        free(load.first);
+        return -1;
+    }
+
+    /* Lay the grids out back to back and plan their reads */
+    int particle_offset = 0;
+    for (int g = 0; g < pd->n_grids; g++) {
+        int count = pd->grid_count[g];
+        load.first[g] = particle_offset;
+        if (count <= 0) continue;
+        particle_offset += count;
+
+        size_t len = (size_t)count * (pd->ndim + pd->n_real_comps) * sizeof(double);
+        if (len > max_len) max_len = len;
+        load.reads[n_reads].file_num = pd->grid_file_num[g];
+        load.reads[n_reads].offset = pd->grid_offset[g];
+        load.reads[n_reads].grid = g;
+        n_reads++;
+    }
+    qsort(load.reads, n_reads, sizeof(SdmGridRead), compare_sdm_grid_reads);
+
+    /* Open each DATA file once; reads arrive grouped by file */
+    for (int n = 0; n < n_reads; n++) {
+        if (n > 0 && load.reads[n].file_num == load.reads[n - 1].file_num) {
+            load.fds[n] = load.fds[n - 1];
+        } else {
+            char path[MAX_PATH];
+            snprintf(path, MAX_PATH, "%s/%s/Level_0/DATA_%05d",
+                     plotfile_dir, SDM_SUBDIR, load.reads[n].file_num);
+            load.fds[n] = open(path, O_RDONLY);
+            if (load.fds[n] < 0) fprintf(stderr, "Error: Cannot open %s\n", path);
+        }
+    }
+
+    int result = uring_read_batch(n_reads, io_depth, max_len, uring_prep_sdm_grid,
+                                  uring_done_sdm_grid, &load);
+    if (result > 0) {
+        fprintf(stderr, "Error: %d of %d particle reads failed in %s\n", result, n_reads, plotfile_dir);
+    }
+    if (result >= 0) {
+        printf("Loaded %d particles from %s\n", particle_offset, plotfile_dir);
+    }
+
+    for (int n = 0; n < n_reads; n++) {
+        if (load.fds[n] >= 0 && (n == 0 || load.fds[n] != load.fds[n - 1])) close(load.fds[n]);
+    }
+    free(load.reads);
+    free(load.fds);
+    free(load.first);
+    return result < 0 ? -1 : 0;
+}
+
 /* Read particle binary data from DATA files */
 int read_sdm_data(ParticleData *pd, const char *plotfile_dir) {
     char path[MAX_PATH];
@@ -1513,14 +6115,14 @@ int read_sdm_data(ParticleData *pd, const char *plotfile_dir) {
     pd->multiplicity = (double *)malloc(pd->n_particles * sizeof(double));
     pd->mass = (double *)malloc(pd->n_particles * sizeof(double));
 
+    /* io_uring queues every grid at once; without it, read grid by grid */
+    if (io_backend == IO_BACKEND_URING && read_sdm_grids_uring(pd, plotfile_dir) == 0) {
+        return 0;
+    }
+
     int ints_per_particle = 2 + pd->n_int_comps;   /* id, cpu, int_comp0, int_comp1, ... */
     int reals_per_particle = pd->ndim + pd->n_real_comps;  /* x,y,z + real comps */
 
-    /* Indices within the real block (0-based, including x,y,z) */
-    int real_radius_idx = pd->ndim + pd->radius_idx;
-    int real_mult_idx = pd->ndim + pd->mult_idx;
-    int real_mass_idx = pd->ndim + pd->mass_idx;
-
     int particle_offset = 0;  /* Running offset into output arrays */
 
     for (int g = 0; g < pd->n_grids; g++) {
@@ -1546,18 +6148,8 @@ int read_sdm_data(ParticleData *pd, const char *plotfile_dir) {
         size_t read_count = fread(real_buf, sizeof(double), (size_t)count * reals_per_particle, fp);
         fclose(fp);
 
-        if ((int)read_count != count * reals_per_particle) {
-            fprintf(stderr, "Warning: Short read for grid %d: got %zu expected %d\n",
-                    g, read_count, count * reals_per_particle);
-        }
-
         /* Extract radius, multiplicity, mass for each particle */
-        for (int p = 0; p < count && (particle_offset + p) < pd->n_particles; p++) {
-            double *pdata = real_buf + (size_t)p * reals_per_particle;
-            pd->radius[particle_offset + p] = pdata[real_radius_idx];
-            pd->multiplicity[particle_offset + p] = pdata[real_mult_idx];
-            pd->mass[particle_offset + p] = pdata[real_mass_idx];
-        }
+        unpack_grid_particles(pd, g, particle_offset, real_buf, read_count);
 
         particle_offset += count;
         free(real_buf);
@@ -1567,60 +6159,184 @@ int read_sdm_data(ParticleData *pd, const char *plotfile_dir) {
     return 0;
 }
 
+/* Copy plane idx along axis out of a dense (Z, Y, X) field into a double
+ * slice; one instance per field storage type. A Z plane is one contiguous
+ * run and a Y plane one contiguous row per layer, so both are straight
+ * copies. An X plane takes one element from every row. */
+#define DEFINE_EXTRACT_PLANE(name, T)                                   \
+static void name##_run(double *dst, const T *src, size_t n) {          \
+    if (sizeof(T) == sizeof(double)) {                                  \
+        memcpy(dst, src, n * sizeof(double));                           \
+    } else {                                                            \
+        for (size_t i = 0; i < n; i++) dst[i] = src[i];                 \
+    }                                                                   \
+}                                                                       \
+static void name(const T *data, const int *dims, double *slice,         \
+                 int axis, int idx) {                                   \
+    size_t nx = dims[0], ny = dims[1], nz = dims[2];                    \
+    if (axis == 2) {  /* Z slice */                                     \
+        name##_run(slice, data + (size_t)idx * ny * nx, nx * ny);       \
+    } else if (axis == 1) {  /* Y slice */                              \
+        for (size_t k = 0; k < nz; k++) {                               \
+            name##_run(slice + k * nx, data + (k * ny + idx) * nx, nx); \
+        }                                                               \
+    } else {  /* X slice */                                             \
+        const T *src = data + idx;                                      \
+        size_t rows = ny * nz;                                          \
+        for (size_t r = 0; r < rows; r++) {                             \
+            slice[r] = src[r * nx];                                     \
+        }                                                               \
+    }                                                                   \
+}
+
+DEFINE_EXTRACT_PLANE(extract_plane_double, double)
+DEFINE_EXTRACT_PLANE(extract_plane_float, float)
+
+/* Extract a 2D slice from any loaded 3D field with the given dims */
+void extract_field_plane(const void *data, const int *dims, double *slice, int axis, int idx) {
+    if (field_float32) {
+        extract_plane_float((const float *)data, dims, slice, axis, idx);
+    } else {
+        extract_plane_double((const double *)data, dims, slice, axis, idx);
+    }
+}
+
+/* Gather X planes x0 .. x0 + width - 1 of a dense field into planes, one
+ * after another, each laid out like an X slice. Rows are taken in blocks
+ * of XTILE_BLOCK so the cache lines of a block are read from memory once
+ * and then shared by every plane. */
+#define DEFINE_GATHER_XTILE(name, T)                                    \
+static void name(const T *data, const int *dims, int x0, int width,     \
+                 T *planes) {                                           \
+    size_t nx = dims[0], rows = (size_t)dims[1] * dims[2];              \
+    for (size_t r0 = 0; r0 < rows; r0 += XTILE_BLOCK) {                 \
+        size_t r1 = (r0 + XTILE_BLOCK < rows) ? r0 + XTILE_BLOCK : rows; \
+        for (int p = 0; p < width; p++) {                               \
+            const T *src = data + x0 + p;                               \
+            T *dst = planes + p * rows;                                 \
+            for (size_t r = r0; r < r1; r++) {                          \
+                dst[r] = src[r * nx];                                   \
+            }                                                           \
+        }                                                               \
+    }                                                                   \
+}
+
+DEFINE_GATHER_XTILE(gather_xtile_double, double)
+DEFINE_GATHER_XTILE(gather_xtile_float, float)
+
+/* Serve X plane idx of the displayed field from the X tile, gathering the
+ * tile that holds it when the tile changed. The tile counts against
+ * --cache-mb, and is dropped when its field is released or the timestep
+ * changes. Returns -1 when it would not fit in a quarter of the budget. */
+static int xtile_plane(const PlotfileData *pf, double *slice, int idx) {
+    const int *dims = pf->grid_dims;
+    size_t rows = (size_t)dims[1] * dims[2];
+    int width = XTILE_LINE / FIELD_ELEM_SIZE;
+    int x0 = idx - idx % width;
+    if (x0 + width > dims[0]) width = dims[0] - x0;
+    size_t bytes = (size_t)width * rows * FIELD_ELEM_SIZE;
+    if (bytes > (size_t)cache_mb * 1024 * 1024 / 4) return -1;
+
+    if (xtile.data != pf->data || xtile.var != pf->current_var ||
+        xtile.level != pf->current_level || xtile.x0 != x0 || xtile.width != width ||
+        memcmp(xtile.dims, dims, sizeof(xtile.dims)) != 0 ||
+        strcmp(xtile.dir, pf->plotfile_dir) != 0) {
+        xtile.data = NULL;  /* Invalid until gathered */
+        if (bytes > xtile.bytes) {
+            void *planes = realloc(xtile.planes, bytes);
+            if (!planes) return -1;
+            xtile.planes = planes;
+            xtile.bytes = bytes;
+            field_cache_trim();  /* Make room among the cached fields */
+        }
+        if (field_float32) {
+            gather_xtile_float((const float *)pf->data, dims, x0, width, (float *)xtile.planes);
+        } else {
+            gather_xtile_double((const double *)pf->data, dims, x0, width, (double *)xtile.planes);
+        }
+        xtile.data = pf->data;
+        xtile.var = pf->current_var;
+        xtile.level = pf->current_level;
+        xtile.x0 = x0;
+        xtile.width = width;
+        memcpy(xtile.dims, dims, sizeof(xtile.dims));
+        snprintf(xtile.dir, sizeof(xtile.dir), "%s", pf->plotfile_dir);
+    }
+
+    size_t offset = (size_t)(idx - x0) * rows;
+    if (field_float32) {
+        extract_plane_float_run(slice, (const float *)xtile.planes + offset, rows);
+    } else {
+        extract_plane_double_run(slice, (const double *)xtile.planes + offset, rows);
+    }
+    return 0;
+}
+
+/* Drop the X tile and its memory */
+void xtile_free(void) {
+    free(xtile.planes);
+    memset(&xtile, 0, sizeof(xtile));
+}
+
 /* Extract 2D slice from 3D data */
 void extract_slice(PlotfileData *pf, double *slice, int axis, int idx) {
-    int i, j, k;
     int nx = pf->grid_dims[0];
     int ny = pf->grid_dims[1];
     int nz = pf->grid_dims[2];
 
-    if (axis == 2) {  /* Z slice */
-        for (j = 0; j < ny; j++) {
-            for (i = 0; i < nx; i++) {
-                slice[j * nx + i] = pf->data[idx * ny * nx + j * nx + i];
+    if (!pf->data) {
+        /* A precomputed sidecar plane is one small read */
+        if (slice_cache_read(pf, pf->current_var, axis, idx, slice) == 0) return;
+
+        /* Out-of-core mode: Z planes come from the chunk holding them, so
+         * scrubbing through its layers costs no further I/O */
+        if (ooc_mb > 0 && axis == 2) {
+            const OocChunk *oc = ooc_chunk(pf, pf->current_var, idx);
+            if (oc) {
+                extract_field_plane(oc->data, oc->dims, slice, 2, idx - oc->z0);
+                return;
             }
         }
-    } else if (axis == 1) {  /* Y slice */
-        for (k = 0; k < nz; k++) {
-            for (i = 0; i < nx; i++) {
-                slice[k * nx + i] = pf->data[k * ny * nx + idx * nx + i];
-            }
+
+        /* Slice mode: serve the plane, reading it if the view moved */
+        size_t n = (size_t)((axis == 0) ? ny : nx) * ((axis == 2) ? ny : nz);
+        if (!pf->plane_valid || pf->plane_var != pf->current_var ||
+            pf->plane_axis != axis || pf->plane_idx != idx) {
+            read_variable_slice(pf, pf->current_var, axis, idx);
         }
-    } else {  /* X slice */
-        for (k = 0; k < nz; k++) {
-            for (j = 0; j < ny; j++) {
-                slice[k * ny + j] = pf->data[k * ny * nx + j * nx + idx];
-            }
+        if (pf->plane_valid) {
+            memcpy(slice, pf->plane, n * sizeof(double));
+        } else {
+            memset(slice, 0, n * sizeof(double));
         }
+        return;
     }
+
+    /* Neighbouring X planes share cache lines, so X scrubbing is served
+     * from a tile of them gathered together */
+    if (axis == 0 && xtile_plane(pf, slice, idx) == 0) return;
+    extract_field_plane(pf->data, pf->grid_dims, slice, axis, idx);
 }
 
-/* Extract slice from a specific level's data */
-void extract_slice_level(LevelData *ld, double *slice, int axis, int idx) {
-    int i, j, k;
-    int nx = ld->grid_dims[0];
-    int ny = ld->grid_dims[1];
-    int nz = ld->grid_dims[2];
+/* In-plane extent of a box on a slice along axis */
+void box_plane_dims(const Box *box, int axis, int *width, int *height) {
+    int dim_x = (axis == 0) ? 1 : 0;
+    int dim_y = (axis == 2) ? 1 : 2;
+    *width = box->hi[dim_x] - box->lo[dim_x] + 1;
+    *height = box->hi[dim_y] - box->lo[dim_y] + 1;
+}
 
-    if (axis == 2) {  /* Z slice */
-        for (j = 0; j < ny; j++) {
-            for (i = 0; i < nx; i++) {
-                slice[j * nx + i] = ld->data[idx * ny * nx + j * nx + i];
-            }
-        }
-    } else if (axis == 1) {  /* Y slice */
-        for (k = 0; k < nz; k++) {
-            for (i = 0; i < nx; i++) {
-                slice[k * nx + i] = ld->data[k * ny * nx + idx * nx + i];
-            }
-        }
-    } else {  /* X slice */
-        for (k = 0; k < nz; k++) {
-            for (j = 0; j < ny; j++) {
-                slice[k * ny + j] = ld->data[k * ny * nx + j * nx + idx];
-            }
-        }
+/* Extract box b of a packed level on the plane at coord (level index space)
+ * into patch, laid out like a slice of that box alone (box_plane_dims).
+ * The box must cross the plane. */
+void extract_level_box_plane(const LevelData *ld, int b, int axis, int coord, double *patch) {
+    const Box *box = &ld->boxes[b];
+    int box_dims[3];
+    for (int d = 0; d < 3; d++) {
+        box_dims[d] = box->hi[d] - box->lo[d] + 1;
     }
+    const char *data = (const char *)ld->data + ld->box_offset[b] * FIELD_ELEM_SIZE;
+    extract_field_plane(data, box_dims, patch, axis, coord - box->lo[axis]);
 }
 
 /* Jet colormap */
@@ -1856,22 +6572,437 @@ const char *get_variable_unit(const char *varname) {
         return "m^2/s^2";
     }
 
-    return "";  /* Unknown - no unit */
-}
-
-/* Apply colormap to data */
-void apply_colormap(double *data, int width, int height, 
-                   unsigned long *pixels, double vmin, double vmax, int cmap_type) {
-    int i, j;
-    double range = vmax - vmin;
-    if (range < 1e-10) range = 1.0;
-    
-    for (j = 0; j < height; j++) {
-        for (i = 0; i < width; i++) {
-            double val = data[j * width + i];
-            double t = (val - vmin) / range;
-            RGB color = get_colormap_rgb(t, cmap_type);
-            pixels[j * width + i] = (color.r << 16) | (color.g << 8) | color.b;
+    return "";  /* Unknown - no unit */
+}
+
+/* Colormap lookup tables: COLORMAP_LUT_SIZE pixels per colormap, sampled
+ * evenly over [0, 1] and packed in the display's pixel format. A slice is
+ * coloured by scaling each value to a table index, with no per-pixel
+ * colormap evaluation. */
+#define N_COLORMAPS 8
+#define COLORMAP_LUT_SIZE 4096
+static unsigned long colormap_lut[N_COLORMAPS][COLORMAP_LUT_SIZE];
+static int colormap_lut_ready[N_COLORMAPS];
+static int pixel_shift[3] = {16, 8, 0};  /* 24-bit RGB until the visual is known */
+static int pixel_bits[3] = {8, 8, 8};
+int colormap_simd = 1;  /* Cleared to time the scalar kernel */
+
+/* Pack a colour into a pixel of the display's TrueColor visual */
+static unsigned long pack_rgb(RGB color) {
+    unsigned char c[3] = {color.r, color.g, color.b};
+    unsigned long pixel = 0;
+    for (int k = 0; k < 3; k++) {
+        unsigned long v = c[k];
+        v = (pixel_bits[k] <= 8) ? v >> (8 - pixel_bits[k]) : v << (pixel_bits[k] - 8);
+        pixel |= v << pixel_shift[k];
+    }
+    return pixel;
+}
+
+/* Take the channel layout from a TrueColor visual; the tables are rebuilt
+ * for it on next use */
+void set_pixel_format(const Visual *visual) {
+    unsigned long masks[3] = {visual->red_mask, visual->green_mask, visual->blue_mask};
+    if (!masks[0] || !masks[1] || !masks[2]) return;
+    for (int k = 0; k < 3; k++) {
+        int shift = 0, bits = 0;
+        while (!((masks[k] >> shift) & 1)) shift++;
+        while ((masks[k] >> (shift + bits)) & 1) bits++;
+        pixel_shift[k] = shift;
+        pixel_bits[k] = bits;
+    }
+    memset(colormap_lut_ready, 0, sizeof(colormap_lut_ready));
+}
+
+static const unsigned long *colormap_table(int cmap_type) {
+    if (cmap_type < 0 || cmap_type >= N_COLORMAPS) cmap_type = 0;
+    unsigned long *lut = colormap_lut[cmap_type];
+    if (!colormap_lut_ready[cmap_type]) {
+        for (int k = 0; k < COLORMAP_LUT_SIZE; k++) {
+            lut[k] = pack_rgb(get_colormap_rgb((double)k / (COLORMAP_LUT_SIZE - 1), cmap_type));
+        }
+        colormap_lut_ready[cmap_type] = 1;
+    }
+    return lut;
+}
+
+/* Pixel for NaN values: white, like the background and box gaps */
+static unsigned long nan_pixel(void) {
+    RGB white = {255, 255, 255};
+    return pack_rgb(white);
+}
+
+/* Normalize, clamp and look up n values. NaN values get nan; infinities
+ * clamp to the ends of the table. With AVX2, four values are scaled,
+ * clamped and gathered from the table at a time. */
+static void colormap_kernel(const double *data, size_t n, unsigned long *pixels, double vmin,
+                            double scale, const unsigned long *lut, unsigned long nan) {
+    const double top = COLORMAP_LUT_SIZE - 1;
+    size_t i = 0;
+#if defined(__AVX2__)
+    if (colormap_simd && sizeof(unsigned long) == sizeof(long long)) {
+        const __m256d v_lo = _mm256_set1_pd(vmin);
+        const __m256d v_scale = _mm256_set1_pd(scale);
+        const __m256d v_zero = _mm256_setzero_pd();
+        const __m256d v_top = _mm256_set1_pd(top);
+        const __m256i v_nan = _mm256_set1_epi64x((long long)nan);
+        for (; i + 4 <= n; i += 4) {
+            __m256d v = _mm256_loadu_pd(data + i);
+            __m256d t = _mm256_mul_pd(_mm256_sub_pd(v, v_lo), v_scale);
+            t = _mm256_min_pd(_mm256_max_pd(t, v_zero), v_top);  /* A NaN t becomes 0 */
+            __m256i px = _mm256_i32gather_epi64((const long long *)lut, _mm256_cvtpd_epi32(t), 8);
+            __m256d is_nan = _mm256_cmp_pd(v, v, _CMP_UNORD_Q);
+            px = _mm256_blendv_epi8(px, v_nan, _mm256_castpd_si256(is_nan));
+            _mm256_storeu_si256((__m256i *)(pixels + i), px);
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        double v = data[i];
+        if (isnan(v)) {
+            pixels[i] = nan;
+            continue;
+        }
+        double t = (v - vmin) * scale;
+        if (!(t >= 0.0)) t = 0.0;
+        if (t > top) t = top;
+        pixels[i] = lut[lrint(t)];  /* Rounds like the vector conversion */
+    }
+}
+
+/* Apply colormap to data */
+void apply_colormap(double *data, int width, int height, 
+                   unsigned long *pixels, double vmin, double vmax, int cmap_type) {
+    double range = vmax - vmin;
+    if (!(range >= 1e-10)) range = 1.0;  /* Also catches a NaN range */
+    colormap_kernel(data, (size_t)width * height, pixels, vmin,
+                    (COLORMAP_LUT_SIZE - 1) / range, colormap_table(cmap_type), nan_pixel());
+}
+
+/* Headless colormap benchmark on a side x side slice: the per-pixel
+ * colormap evaluation against the table kernel, scalar and vectorized,
+ * for every colormap. Values sweep the range and a few are NaN. */
+int run_colormap_benchmark(int side) {
+    size_t n = (size_t)side * side;
+    double *data = (double *)malloc(n * sizeof(double));
+    unsigned long *ref = (unsigned long *)malloc(n * sizeof(unsigned long));
+    unsigned long *pixels = (unsigned long *)malloc(n * sizeof(unsigned long));
+    if (!data || !ref || !pixels) {
+        fprintf(stderr, "Error: Cannot allocate a %d x %d benchmark slice\n", side, side);
+        free(data);
+        free(ref);
+        free(pixels);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (i % 9973 == 0) ? NAN : sin(i * 1e-3) * 300.0 + (double)(i % side) / side;
+    }
+    double vmin = -300.0, vmax = 301.0;
+    const char *names[N_COLORMAPS] = {"viridis", "jet", "turbo", "plasma", "hot", "cool",
+                                      "gray", "magma"};
+#if defined(__AVX2__)
+    const char *vector = "AVX2";
+#else
+    const char *vector = "none (built without AVX2)";
+#endif
+
+    printf("\nColormap benchmark: %d x %d slice (%.1f Mpixel), %d-entry tables, vector kernel: %s\n",
+           side, side, n / 1e6, COLORMAP_LUT_SIZE, vector);
+    printf("  %-8s %12s %12s %12s %10s\n", "colormap", "per-pixel", "table", "table+SIMD",
+           "max error");
+    for (int c = 0; c < N_COLORMAPS; c++) {
+        double range = vmax - vmin;
+        double t0 = wall_seconds();
+        for (size_t i = 0; i < n; i++) {
+            ref[i] = isnan(data[i]) ? nan_pixel()
+                                    : pack_rgb(get_colormap_rgb((data[i] - vmin) / range, c));
+        }
+        double t_ref = wall_seconds() - t0;
+
+        double t_kernel[2];
+        for (int simd = 0; simd < 2; simd++) {
+            colormap_simd = simd;
+            colormap_table(c);  /* Built once, outside the timing */
+            t_kernel[simd] = 1e30;
+            for (int rep = 0; rep < 3; rep++) {
+                t0 = wall_seconds();
+                apply_colormap(data, side, side, pixels, vmin, vmax, c);
+                double dt = wall_seconds() - t0;
+                if (dt < t_kernel[simd]) t_kernel[simd] = dt;
+            }
+        }
+        colormap_simd = 1;
+
+        /* Largest channel difference from the exact colour */
+        int max_err = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (int k = 0; k < 3; k++) {
+                int mask = (1 << pixel_bits[k]) - 1;
+                int d = (int)((ref[i] >> pixel_shift[k]) & mask) - (int)((pixels[i] >> pixel_shift[k]) & mask);
+                if (abs(d) > max_err) max_err = abs(d);
+            }
+        }
+        printf("  %-8s %9.1f ms %9.1f ms %9.1f ms %10d\n", names[c], t_ref * 1e3,
+               t_kernel[0] * 1e3, t_kernel[1] * 1e3, max_err);
+    }
+
+    free(data);
+    free(ref);
+    free(pixels);
+    return 0;
+}
+
+/* Cell pixels for a slice of n cells, grown as needed */
+static unsigned long *cell_pixels(size_t n) {
+    static size_t capacity = 0;
+    if (n > capacity || !pixel_data) {
+        unsigned long *grown = (unsigned long *)realloc(pixel_data, n * sizeof(unsigned long));
+        if (!grown) return NULL;
+        pixel_data = grown;
+        capacity = n;
+    }
+    return pixel_data;
+}
+
+/* MIT-SHM needs a server that can attach our memory: a local display
+ * (":0", "unix:0" or a socket path) offering the extension. Forwarded
+ * displays ("localhost:10.0") use the socket. */
+static int display_is_local(Display *dpy) {
+    const char *name = DisplayString(dpy);
+    return name && (name[0] == ':' || name[0] == '/' || strncmp(name, "unix:", 5) == 0);
+}
+
+static int shm_attach_failed = 0;
+static int shm_error_handler(Display *dpy, XErrorEvent *ev) {
+    shm_attach_failed = 1;
+    return 0;
+}
+
+/* Image backed by a shared segment the server reads directly. Returns NULL
+ * when MIT-SHM is unavailable or the attach fails. */
+static XImage *create_shm_image(int width, int height) {
+    if (!display_is_local(display) || !XShmQueryExtension(display)) return NULL;
+
+    XImage *img = XShmCreateImage(display, DefaultVisual(display, screen),
+                                  DefaultDepth(display, screen), ZPixmap, NULL,
+                                  &shm_info, width, height);
+    if (!img) return NULL;
+    shm_info.shmid = shmget(IPC_PRIVATE, (size_t)img->bytes_per_line * height, IPC_CREAT | 0600);
+    if (shm_info.shmid < 0) {
+        XDestroyImage(img);
+        return NULL;
+    }
+    shm_info.shmaddr = img->data = (char *)shmat(shm_info.shmid, NULL, 0);
+    shm_info.readOnly = False;
+    if (shm_info.shmaddr == (char *)-1) {
+        shmctl(shm_info.shmid, IPC_RMID, NULL);
+        img->data = NULL;
+        XDestroyImage(img);
+        return NULL;
+    }
+
+    /* The attach fails with an X error when the server cannot see the
+     * segment; catch it rather than exit */
+    XErrorHandler old_handler = XSetErrorHandler(shm_error_handler);
+    shm_attach_failed = 0;
+    XShmAttach(display, &shm_info);
+    XSync(display, False);
+    XSetErrorHandler(old_handler);
+
+    /* Marked for removal now; it goes away once both sides detach */
+    shmctl(shm_info.shmid, IPC_RMID, NULL);
+    if (shm_attach_failed) {
+        shmdt(shm_info.shmaddr);
+        img->data = NULL;
+        XDestroyImage(img);
+        return NULL;
+    }
+    return img;
+}
+
+/* Create the frame image for a width x height canvas: in a shared segment
+ * when the server is local, else in client memory sent with XPutImage */
+void create_frame_image(int width, int height) {
+    ximage = create_shm_image(width, height);
+    frame_shm = ximage != NULL;
+    if (!ximage) {
+        ximage = XCreateImage(display, DefaultVisual(display, screen), DefaultDepth(display, screen),
+                              ZPixmap, 0, NULL, width, height, 32, 0);
+        if (ximage) {
+            ximage->data = (char *)malloc((size_t)ximage->bytes_per_line * height);
+            if (!ximage->data) {
+                XDestroyImage(ximage);
+                ximage = NULL;
+            }
+        }
+    }
+    frame_col = ximage ? (int *)malloc((size_t)width * sizeof(int)) : NULL;
+    frame_row = ximage ? (int *)malloc((size_t)height * sizeof(int)) : NULL;
+    if (ximage && (!frame_col || !frame_row)) destroy_frame_image();
+    if (!ximage) {
+        fprintf(stderr, "Warning: Cannot create the frame image, drawing cells one by one\n");
+        return;
+    }
+
+    int one = 1;
+    int host_order = *(char *)&one ? LSBFirst : MSBFirst;
+    ximage_fast32 = ximage->bits_per_pixel == 32 && ximage->byte_order == host_order;
+    printf("Frame image: %d x %d, %d bpp, %s\n", width, height, ximage->bits_per_pixel,
+           frame_shm ? "MIT-SHM" : "XPutImage");
+}
+
+void destroy_frame_image(void) {
+    free(frame_col);
+    free(frame_row);
+    frame_col = frame_row = NULL;
+    if (!ximage) return;
+    if (frame_shm) {
+        XShmDetach(display, &shm_info);
+        XSync(display, False);
+        shmdt(shm_info.shmaddr);
+        ximage->data = NULL;  /* Not ours to free */
+    }
+    XDestroyImage(ximage);  /* Frees client-memory data too */
+    ximage = NULL;
+    frame_shm = 0;
+}
+
+/* The server reads a shared image after XShmPutImage returns, so wait for
+ * it to finish before drawing into the image again */
+static void frame_image_wait(void) {
+    if (frame_shm_busy) {
+        XSync(display, False);
+        frame_shm_busy = 0;
+    }
+}
+
+/* Send a rectangle of the frame image to the same place in the back buffer */
+static void frame_image_put(int x, int y, int w, int h) {
+    if (frame_shm) {
+        XShmPutImage(display, pixmap, gc, ximage, x, y, x, y, w, h, False);
+        frame_shm_busy = 1;
+    } else {
+        XPutImage(display, pixmap, gc, ximage, x, y, x, y, w, h);
+    }
+}
+
+static inline void image_put_pixel(int x, int y, unsigned long pixel) {
+    if (ximage_fast32) {
+        ((uint32_t *)(ximage->data + (size_t)y * ximage->bytes_per_line))[x] = (uint32_t)pixel;
+    } else {
+        XPutPixel(ximage, x, y, pixel);
+    }
+}
+
+/* Fill a rectangle of the frame image, clipped to the canvas. Without an
+ * image the rectangle goes straight to the back buffer. */
+void image_fill_rect(int x, int y, int w, int h, unsigned long pixel) {
+    if (!ximage) {
+        XSetForeground(display, gc, pixel);
+        XFillRectangle(display, pixmap, gc, x, y, w, h);
+        return;
+    }
+    int x1 = x + w, y1 = y + h;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > ximage->width) x1 = ximage->width;
+    if (y1 > ximage->height) y1 = ximage->height;
+    frame_image_wait();
+    for (int py = y; py < y1; py++) {
+        for (int px = x; px < x1; px++) {
+            image_put_pixel(px, py, pixel);
+        }
+    }
+}
+
+/* Send a rectangle of the frame image to the back buffer */
+void image_flush(int x, int y, int w, int h) {
+    if (!ximage) return;
+    int x1 = x + w, y1 = y + h;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > ximage->width) x1 = ximage->width;
+    if (y1 > ximage->height) y1 = ximage->height;
+    if (x1 > x && y1 > y) frame_image_put(x, y, x1 - x, y1 - y);
+}
+
+/* Rasterize a cw x ch patch of cell pixels into the frame image; send it
+ * with image_flush once everything on the plot is drawn. Patch cell
+ * (pi, pj) is cell (li0 + pi, lj0 + pj) of a grid drawn from (sx0, sy0)
+ * in cells of cell_w x cell_h pixels, with row 0 at the bottom of lheight
+ * rows. Each cell covers the pixels its own rectangle used to, at least
+ * one, and later cells win where they overlap. Cells whose mask entry is
+ * 0 are left white. The work follows the pixels the patch covers, so many
+ * small boxes cost no more than one large one. */
+void put_cell_image(const unsigned long *pixels, const unsigned char *mask, int cw, int ch,
+                    int li0, int lj0, int lheight, int sx0, int sy0,
+                    double cell_w, double cell_h) {
+    unsigned long white = WhitePixel(display, screen);
+    if (cw <= 0 || ch <= 0) return;
+
+    if (!ximage) {
+        /* No frame image: one rectangle per cell, as before */
+        for (int pj = 0; pj < ch; pj++) {
+            int flipped_lj = lheight - 1 - (lj0 + pj);
+            int y = sy0 + (int)(flipped_lj * cell_h);
+            int h = (int)((flipped_lj + 1) * cell_h) - (int)(flipped_lj * cell_h);
+            for (int pi = 0; pi < cw; pi++) {
+                if (mask && !mask[pj * cw + pi]) continue;
+                int li = li0 + pi;
+                int x = sx0 + (int)(li * cell_w);
+                int w = (int)((li + 1) * cell_w) - (int)(li * cell_w);
+                XSetForeground(display, gc, pixels[pj * cw + pi]);
+                XFillRectangle(display, pixmap, gc, x, y, w < 1 ? 1 : w, h < 1 ? 1 : h);
+            }
+        }
+        return;
+    }
+
+    /* Screen column -> patch column and screen row -> patch row. Each cell
+     * starts where the one before it ends, so every pixel between the
+     * first and last cell is set and nothing outside that span is read. */
+    int *col = frame_col, *row = frame_row;
+    int x_lo = ximage->width, x_hi = 0, y_lo = ximage->height, y_hi = 0;
+    for (int pi = 0; pi < cw; pi++) {
+        int li = li0 + pi;
+        int x = sx0 + (int)(li * cell_w);
+        int w = (int)((li + 1) * cell_w) - (int)(li * cell_w);
+        if (w < 1) w = 1;
+        for (int px = x; px < x + w; px++) {
+            if (px < 0 || px >= ximage->width) continue;
+            col[px] = pi;
+            if (px < x_lo) x_lo = px;
+            if (px >= x_hi) x_hi = px + 1;
+        }
+    }
+    for (int pj = 0; pj < ch; pj++) {
+        int flipped_lj = lheight - 1 - (lj0 + pj);
+        int y = sy0 + (int)(flipped_lj * cell_h);
+        int h = (int)((flipped_lj + 1) * cell_h) - (int)(flipped_lj * cell_h);
+        if (h < 1) h = 1;
+        for (int py = y; py < y + h; py++) {
+            if (py < 0 || py >= ximage->height) continue;
+            row[py] = pj;
+            if (py < y_lo) y_lo = py;
+            if (py >= y_hi) y_hi = py + 1;
+        }
+    }
+
+    /* Rows repeating the one above are copied whole */
+    frame_image_wait();
+    int copy_rows = ximage->bits_per_pixel % 8 == 0;
+    size_t row_off = (size_t)x_lo * ximage->bits_per_pixel / 8;
+    size_t row_len = (size_t)(x_hi - x_lo) * ximage->bits_per_pixel / 8;
+    for (int y = y_lo; y < y_hi; y++) {
+        int pj = row[y];
+        if (copy_rows && y > y_lo && pj == row[y - 1]) {
+            memcpy(ximage->data + (size_t)y * ximage->bytes_per_line + row_off,
+                   ximage->data + (size_t)(y - 1) * ximage->bytes_per_line + row_off, row_len);
+            continue;
+        }
+        for (int x = x_lo; x < x_hi; x++) {
+            size_t c = (size_t)pj * cw + col[x];
+            image_put_pixel(x, y, (mask && !mask[c]) ? white : pixels[c]);
         }
     }
 }
@@ -1882,9 +7013,9 @@ void draw_colorbar(double vmin, double vmax, int cmap_type, const char *varname)
     int top_margin = 50;   /* Extra space at top for variable name */
     int bottom_margin = 10;
 
-    /* Clear colorbar with white background */
+    /* Compose in the colorbar's back buffer. Clear it with white background. */
     XSetForeground(display, colorbar_gc, WhitePixel(display, screen));
-    XFillRectangle(display, colorbar, colorbar_gc, 0, 0, 100, canvas_height);
+    XFillRectangle(display, colorbar_pixmap, colorbar_gc, 0, 0, 100, canvas_height);
 
     /* Draw variable name at top */
     XSetForeground(display, text_gc, BlackPixel(display, screen));
@@ -1899,14 +7030,14 @@ void draw_colorbar(double vmin, double vmax, int cmap_type, const char *varname)
             strncpy(short_name, varname, 15);
             short_name[15] = '\0';
         }
-        XDrawString(display, colorbar, text_gc, 2, 15, short_name, strlen(short_name));
+        XDrawString(display, colorbar_pixmap, text_gc, 2, 15, short_name, strlen(short_name));
 
         /* Draw unit below variable name */
         const char *unit = get_variable_unit(varname);
         if (unit && strlen(unit) > 0) {
             char unit_str[20];
             snprintf(unit_str, sizeof(unit_str), "[%s]", unit);
-            XDrawString(display, colorbar, text_gc, 2, 30, unit_str, strlen(unit_str));
+            XDrawString(display, colorbar_pixmap, text_gc, 2, 30, unit_str, strlen(unit_str));
         }
     }
 
@@ -1914,13 +7045,13 @@ void draw_colorbar(double vmin, double vmax, int cmap_type, const char *varname)
     for (int i = 0; i < height; i++) {
         double t = (double)(height - 1 - i) / (height - 1);
         RGB color = get_colormap_rgb(t, cmap_type);
-        unsigned long pixel = (color.r << 16) | (color.g << 8) | color.b;
+        unsigned long pixel = pack_rgb(color);
 
         XSetForeground(display, colorbar_gc, pixel);
         int y = top_margin + (i * (canvas_height - top_margin - bottom_margin)) / height;
         int h = top_margin + ((i + 1) * (canvas_height - top_margin - bottom_margin)) / height - y;
         if (h < 1) h = 1;
-        XFillRectangle(display, colorbar, colorbar_gc, 0, y, width, h);
+        XFillRectangle(display, colorbar_pixmap, colorbar_gc, 0, y, width, h);
     }
 
     /* Draw tick marks and labels */
@@ -1938,17 +7069,82 @@ void draw_colorbar(double vmin, double vmax, int cmap_type, const char *varname)
                 (int)(fraction * (canvas_height - top_margin - bottom_margin));
 
         /* Draw tick mark */
-        XDrawLine(display, colorbar, text_gc, width, y, width + 5, y);
+        XDrawLine(display, colorbar_pixmap, text_gc, width, y, width + 5, y);
 
         /* Draw label with vertical centering adjustment */
         snprintf(text, sizeof(text), "%.2e", value);
-        XDrawString(display, colorbar, text_gc, width + 8, y + 4, text, strlen(text));
+        XDrawString(display, colorbar_pixmap, text_gc, width + 8, y + 4, text, strlen(text));
     }
 
+    XCopyArea(display, colorbar_pixmap, colorbar, colorbar_gc, 0, 0, 100, canvas_height, 0, 0);
+    colorbar_valid = 1;
     XFlush(display);
 }
 
 /* Initialize GUI with Athena Widgets */
+/* Level buttons for every level seen so far, followed by the overlay
+ * toggle. Called again when the background timestep scan finds a plotfile
+ * with more levels; buttons are only ever added. */
+void update_level_buttons(int total_levels) {
+    Arg args[10];
+    int n;
+    char label_text[32];
+
+    /* Add level buttons for all levels across all timesteps (limit to 10) */
+    if (total_levels > 10) total_levels = 10;
+    if (total_levels <= 1 || total_levels <= n_level_buttons) return;
+
+    if (!level_box) {
+        n = 0;
+        XtSetArg(args[n], XtNfromVert, canvas_widget); n++;
+        XtSetArg(args[n], XtNfromHoriz, axis_box); n++;
+        XtSetArg(args[n], XtNborderWidth, 1); n++;
+        XtSetArg(args[n], XtNorientation, XtorientHorizontal); n++;
+        XtSetArg(args[n], XtNbottom, XawChainBottom); n++;
+        XtSetArg(args[n], XtNleft, XawChainLeft); n++;
+        level_box = XtCreateManagedWidget("levelBox", boxWidgetClass, form, args, n);
+    }
+
+    /* The overlay toggle stays last: recreate it after the new buttons */
+    snprintf(label_text, sizeof(label_text), "Overlay: OFF");
+    if (overlay_button) {
+        String label = NULL;
+        XtSetArg(args[0], XtNlabel, &label);
+        XtGetValues(overlay_button, args, 1);
+        if (label) snprintf(label_text, sizeof(label_text), "%s", label);
+        XtDestroyWidget(overlay_button);
+        overlay_button = NULL;
+    }
+    char overlay_label[32];
+    snprintf(overlay_label, sizeof(overlay_label), "%s", label_text);
+
+    for (int i = n_level_buttons; i < total_levels; i++) {
+        n = 0;
+        snprintf(label_text, sizeof(label_text), "Level %d", i);
+        XtSetArg(args[n], XtNlabel, label_text); n++;
+        Widget button = XtCreateManagedWidget(label_text, commandWidgetClass, level_box, args, n);
+        XtAddCallback(button, XtNcallback, level_button_callback, (XtPointer)(long)i);
+    }
+    n_level_buttons = total_levels;
+
+    /* Add overlay toggle button if more than one level possible */
+    n = 0;
+    XtSetArg(args[n], XtNlabel, overlay_label); n++;
+    overlay_button = XtCreateManagedWidget("overlay", commandWidgetClass, level_box, args, n);
+    XtAddCallback(overlay_button, XtNcallback, overlay_button_callback, NULL);
+}
+
+/* Fold background timestep scan results into the timeline and the level
+ * buttons, rescheduling until the scan is done */
+void scan_poll_timeout(XtPointer client_data, XtIntervalId *id) {
+    int changes = poll_timestep_scan(0);
+    if (changes & TIMESTEP_SCAN_LEVELS) update_level_buttons(max_levels_all_timesteps);
+    if (changes & TIMESTEP_SCAN_TIMELINE) update_time_label();
+    if (timestep_scan.active) {
+        XtAppAddTimeOut((XtAppContext)client_data, 100, scan_poll_timeout, client_data);
+    }
+}
+
 void init_gui(PlotfileData *pf, int argc, char **argv) {
     Arg args[20];
     int n, i;
@@ -1960,6 +7156,7 @@ void init_gui(PlotfileData *pf, int argc, char **argv) {
     toplevel = XtAppInitialize(NULL, "PLTView", NULL, 0, &argc, argv, NULL, NULL, 0);
     display = XtDisplay(toplevel);
     screen = DefaultScreen(display);
+    set_pixel_format(DefaultVisual(display, screen));
     
     /* Load font */
     font = XLoadQueryFont(display, "fixed");
@@ -2122,34 +7319,7 @@ void init_gui(PlotfileData *pf, int argc, char **argv) {
     /* COLUMN 3: Level buttons (show if any timestep has multiple levels) */
     /* Use max_levels_all_timesteps for multi-timestep mode, pf->n_levels for single plotfile */
     int total_levels = (n_timesteps > 1) ? max_levels_all_timesteps : pf->n_levels;
-    if (total_levels > 1) {
-        n = 0;
-        XtSetArg(args[n], XtNfromVert, canvas_widget); n++;
-        XtSetArg(args[n], XtNfromHoriz, axis_box); n++;
-        XtSetArg(args[n], XtNborderWidth, 1); n++;
-        XtSetArg(args[n], XtNorientation, XtorientHorizontal); n++;
-        XtSetArg(args[n], XtNbottom, XawChainBottom); n++;
-        XtSetArg(args[n], XtNleft, XawChainLeft); n++;
-        Widget level_box = XtCreateManagedWidget("levelBox", boxWidgetClass, form, args, n);
-
-        /* Add level buttons for all levels across all timesteps (limit to 10) */
-        int max_levels = total_levels < 10 ? total_levels : 10;
-        for (i = 0; i < max_levels; i++) {
-            n = 0;
-            snprintf(label_text, sizeof(label_text), "Level %d", i);
-            XtSetArg(args[n], XtNlabel, label_text); n++;
-            button = XtCreateManagedWidget(label_text, commandWidgetClass, level_box, args, n);
-            XtAddCallback(button, XtNcallback, level_button_callback, (XtPointer)(long)i);
-        }
-
-        /* Add overlay toggle button if more than one level possible */
-        if (total_levels > 1) {
-            n = 0;
-            XtSetArg(args[n], XtNlabel, "Overlay: OFF"); n++;
-            overlay_button = XtCreateManagedWidget("overlay", commandWidgetClass, level_box, args, n);
-            XtAddCallback(overlay_button, XtNcallback, overlay_button_callback, NULL);
-        }
-    }
+    update_level_buttons(total_levels);
 
     /* ROW 2: Time navigation (only if multiple timesteps) */
     if (n_timesteps > 1) {
@@ -2231,11 +7401,14 @@ void init_gui(PlotfileData *pf, int argc, char **argv) {
     XSetBackground(display, text_gc, WhitePixel(display, screen));
     if (font) XSetFont(display, text_gc, font->fid);
     
-    /* Allocate pixel buffer */
-    pixel_data = (unsigned long *)malloc(canvas_width * canvas_height * sizeof(unsigned long));
+    /* Back buffer the frame is composed in, and the client-side image the
+     * data area is rasterized into in the server's pixel format */
     pixmap = XCreatePixmap(display, canvas, canvas_width, canvas_height, 
                           DefaultDepth(display, screen));
-    colorbar_pixmap = XCreatePixmap(display, colorbar, 100, 256,
+    XSetForeground(display, gc, WhitePixel(display, screen));
+    XFillRectangle(display, pixmap, gc, 0, 0, canvas_width, canvas_height);
+    create_frame_image(canvas_width, canvas_height);
+    colorbar_pixmap = XCreatePixmap(display, colorbar, 100, canvas_height,
                                    DefaultDepth(display, screen));
     
     /* Add event handlers */
@@ -2301,7 +7474,7 @@ void var_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
     int var = (int)(long)client_data;
     if (global_pf && var < global_pf->n_vars) {
         global_pf->current_var = var;
-        read_variable_data(global_pf, var);
+        load_variable(global_pf, var);
 
         /* If overlay mode is on, reload all overlay levels with the new variable */
         if (global_pf->overlay_mode) {
@@ -2310,6 +7483,7 @@ void var_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
 
         update_info_label(global_pf);
         render_slice(global_pf);
+        schedule_prefetch(global_pf);
     }
 }
 
@@ -2724,7 +7898,7 @@ void level_button_callback(Widget w, XtPointer client_data, XtPointer call_data)
     /* Reload data for new level */
     global_pf->n_boxes = 0;
     read_cell_h(global_pf);
-    read_variable_data(global_pf, global_pf->current_var);
+    load_variable(global_pf, global_pf->current_var);
 
     /* Clamp slice_idx if new level has fewer layers */
     int max_idx = global_pf->grid_dims[global_pf->slice_axis] - 1;
@@ -3062,6 +8236,38 @@ void range_auto_callback(Widget w, XtPointer client_data, XtPointer call_data) {
     }
 }
 
+/* Global range callback - full-volume range of the variable taken from the
+ * Cell_H min/max tables, so no field data is read. The dialog stays open
+ * with the range filled in, ready to be adjusted. */
+void range_global_callback(Widget w, XtPointer client_data, XtPointer call_data) {
+    RangeDialogData *data = (RangeDialogData *)client_data;
+    double vmin, vmax;
+
+    if (!global_pf) return;
+    if (variable_global_range(global_pf, global_pf->current_var, &vmin, &vmax) < 0 || vmin >= vmax) {
+        fprintf(stderr, "Warning: No Cell_H min/max tables for %s\n",
+                global_pf->variables[global_pf->current_var]);
+        return;
+    }
+
+    custom_vmin = vmin;
+    custom_vmax = vmax;
+    use_custom_range = 1;
+    render_slice(global_pf);
+
+    if (data) {
+        char min_str[64], max_str[64];
+        Arg args[1];
+
+        snprintf(min_str, sizeof(min_str), "%.6e", vmin);
+        snprintf(max_str, sizeof(max_str), "%.6e", vmax);
+        XtSetArg(args[0], XtNstring, min_str);
+        XtSetValues(data->min_text, args, 1);
+        XtSetArg(args[0], XtNstring, max_str);
+        XtSetValues(data->max_text, args, 1);
+    }
+}
+
 /* Close range dialog callback */
 void range_close_callback(Widget w, XtPointer client_data, XtPointer call_data) {
     RangeDialogData *data = (RangeDialogData *)client_data;
@@ -3189,6 +8395,14 @@ void range_button_callback(Widget w, XtPointer client_data, XtPointer call_data)
         button = XtCreateManagedWidget("auto", commandWidgetClass, form, args, n);
         XtAddCallback(button, XtNcallback, range_auto_callback, (XtPointer)range_data);
 
+        /* Global button */
+        n = 0;
+        XtSetArg(args[n], XtNfromVert, max_label); n++;
+        XtSetArg(args[n], XtNfromHoriz, button); n++;
+        XtSetArg(args[n], XtNlabel, "Global"); n++;
+        button = XtCreateManagedWidget("global", commandWidgetClass, form, args, n);
+        XtAddCallback(button, XtNcallback, range_global_callback, (XtPointer)range_data);
+
         /* Close button */
         n = 0;
         XtSetArg(args[n], XtNfromVert, max_label); n++;
@@ -3306,19 +8520,34 @@ void colormap_button_callback(Widget w, XtPointer client_data, XtPointer call_da
     }
 }
 
+/* Repair the damaged rectangle of the canvas or colorbar from its back
+ * buffer. Only a window that has never been drawn is rendered; uncovering
+ * the window never re-reads or recolours the data. */
+void expose_window(Window win, int x, int y, int w, int h) {
+    if (win == canvas) {
+        if (frame_valid) {
+            XCopyArea(display, pixmap, canvas, gc, x, y, w, h, x, y);
+        } else if (global_pf && field_available(global_pf)) {
+            render_slice(global_pf);
+        }
+    } else if (win == colorbar) {
+        if (colorbar_valid) {
+            XCopyArea(display, colorbar_pixmap, colorbar, colorbar_gc, x, y, w, h, x, y);
+        } else if (global_pf) {
+            draw_colorbar(current_vmin, current_vmax, global_pf->colormap,
+                          global_pf->variables[global_pf->current_var]);
+        }
+    }
+}
+
 /* Canvas expose callback */
 void canvas_expose_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf && global_pf->data) {
-        render_slice(global_pf);
-    }
+    expose_window(canvas, 0, 0, canvas_width, canvas_height);
 }
 
 /* Colorbar expose callback */
 void colorbar_expose_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf) {
-        draw_colorbar(current_vmin, current_vmax, global_pf->colormap,
-                      global_pf->variables[global_pf->current_var]);
-    }
+    expose_window(colorbar, 0, 0, 100, canvas_height);
 }
 void render_slice(PlotfileData *pf) {
     int width, height;
@@ -3352,7 +8581,18 @@ void render_slice(PlotfileData *pf) {
         y_axis = 2;  /* Z */
     }
 
-    slice = (double *)malloc(width * height * sizeof(double));
+    if ((size_t)width * height > current_slice_cap) {
+        free(current_slice_data);
+        current_slice_cap = (size_t)width * height;
+        current_slice_data = (double *)malloc(current_slice_cap * sizeof(double));
+        if (!current_slice_data) {
+            fprintf(stderr, "Error: Cannot allocate a %d x %d slice\n", width, height);
+            current_slice_cap = 0;
+            slice_width = slice_height = 0;
+            return;
+        }
+    }
+    slice = current_slice_data;
     extract_slice(pf, slice, pf->slice_axis, pf->slice_idx);
 
     /* Physical coordinate ranges for axes */
@@ -3368,10 +8608,7 @@ void render_slice(PlotfileData *pf) {
         phys_ymax = pf->prob_hi[y_axis];
     }
 
-    /* Store current slice for mouse interaction */
-    if (current_slice_data) free(current_slice_data);
-    current_slice_data = (double *)malloc(width * height * sizeof(double));
-    memcpy(current_slice_data, slice, width * height * sizeof(double));
+    /* The slice stays in current_slice_data for mouse interaction */
     slice_width = width;
     slice_height = height;
 
@@ -3380,34 +8617,24 @@ void render_slice(PlotfileData *pf) {
     unsigned char *base_in_box = NULL;
     if (pf->current_level > 0 && pf->n_boxes > 1) {
         base_in_box = (unsigned char *)calloc(width * height, 1);
+        int *hits = (int *)malloc(pf->n_boxes * sizeof(int));
         int base_slice_coord = pf->slice_idx + pf->level_lo[pf->slice_axis];
-        for (int bi = 0; bi < pf->n_boxes; bi++) {
-            Box *box = &pf->boxes[bi];
-            if (base_slice_coord < box->lo[pf->slice_axis] || base_slice_coord > box->hi[pf->slice_axis])
-                continue;
-            int dim_x, dim_y;
-            if (pf->slice_axis == 2) { dim_x = 0; dim_y = 1; }
-            else if (pf->slice_axis == 1) { dim_x = 0; dim_y = 2; }
-            else { dim_x = 1; dim_y = 2; }
-            int mi_lo = box->lo[dim_x] - pf->level_lo[dim_x];
-            int mi_hi = box->hi[dim_x] - pf->level_lo[dim_x];
-            int mj_lo = box->lo[dim_y] - pf->level_lo[dim_y];
-            int mj_hi = box->hi[dim_y] - pf->level_lo[dim_y];
-            if (mi_lo < 0) mi_lo = 0;
-            if (mj_lo < 0) mj_lo = 0;
-            if (mi_hi >= width) mi_hi = width - 1;
-            if (mj_hi >= height) mj_hi = height - 1;
-            for (int mj = mj_lo; mj <= mj_hi; mj++)
-                for (int mi = mi_lo; mi <= mi_hi; mi++)
-                    base_in_box[mj * width + mi] = 1;
-        }
-    }
-
-    /* Find data min/max, skipping gap cells when mask is active */
-    for (i = 0; i < width * height; i++) {
-        if (base_in_box && !base_in_box[i]) continue;
-        if (slice[i] < vmin) vmin = slice[i];
-        if (slice[i] > vmax) vmax = slice[i];
+        int n_hits = box_index_plane(&pf->box_index, pf->boxes, pf->slice_axis, base_slice_coord, hits);
+        box_slice_mask(base_in_box, width, height, pf->boxes, hits, n_hits, pf->slice_axis, pf->level_lo);
+        free(hits);
+    }
+
+    /* Find data min/max, skipping gap cells when mask is active. With Cell_H
+     * range tables only boxes that can widen the range are scanned. */
+    if (slice_range_indexed(slice, width, height, pf->boxes, pf->n_boxes, &pf->box_index,
+                            &pf->ranges, pf->current_var, pf->slice_axis,
+                            pf->slice_idx + pf->level_lo[pf->slice_axis],
+                            pf->level_lo, &vmin, &vmax) < 0) {
+        for (i = 0; i < width * height; i++) {
+            if (base_in_box && !base_in_box[i]) continue;
+            if (slice[i] < vmin) vmin = slice[i];
+            if (slice[i] > vmax) vmax = slice[i];
+        }
     }
 
     /* When overlay mode is on, include all overlay levels in min/max for consistent colorbar */
@@ -3462,46 +8689,9 @@ void render_slice(PlotfileData *pf) {
 
             if (lev_slice_idx < 0 || lev_slice_idx >= ld->grid_dims[pf->slice_axis]) continue;
 
-            /* Extract slice and find min/max */
-            int lw, lh;
-            if (pf->slice_axis == 2) { lw = ld->grid_dims[0]; lh = ld->grid_dims[1]; }
-            else if (pf->slice_axis == 1) { lw = ld->grid_dims[0]; lh = ld->grid_dims[2]; }
-            else { lw = ld->grid_dims[1]; lh = ld->grid_dims[2]; }
-
-            double *lev_slice = (double *)malloc(lw * lh * sizeof(double));
-            extract_slice_level(ld, lev_slice, pf->slice_axis, lev_slice_idx);
-
-            /* Build mask so we only consider cells inside actual boxes, not zero-filled gaps */
-            unsigned char *mm_in_box = (unsigned char *)calloc(lw * lh, 1);
-            int mm_slice_coord = lev_slice_idx + ld->level_lo[pf->slice_axis];
-            for (int bi = 0; bi < ld->n_boxes; bi++) {
-                Box *box = &ld->boxes[bi];
-                if (mm_slice_coord < box->lo[pf->slice_axis] || mm_slice_coord > box->hi[pf->slice_axis])
-                    continue;
-                int dim_x, dim_y;
-                if (pf->slice_axis == 2) { dim_x = 0; dim_y = 1; }
-                else if (pf->slice_axis == 1) { dim_x = 0; dim_y = 2; }
-                else { dim_x = 1; dim_y = 2; }
-                int mi_lo = box->lo[dim_x] - ld->level_lo[dim_x];
-                int mi_hi = box->hi[dim_x] - ld->level_lo[dim_x];
-                int mj_lo = box->lo[dim_y] - ld->level_lo[dim_y];
-                int mj_hi = box->hi[dim_y] - ld->level_lo[dim_y];
-                if (mi_lo < 0) mi_lo = 0;
-                if (mj_lo < 0) mj_lo = 0;
-                if (mi_hi >= lw) mi_hi = lw - 1;
-                if (mj_hi >= lh) mj_hi = lh - 1;
-                for (int mj = mj_lo; mj <= mj_hi; mj++)
-                    for (int mi = mi_lo; mi <= mi_hi; mi++)
-                        mm_in_box[mj * lw + mi] = 1;
-            }
-
-            for (int j = 0; j < lw * lh; j++) {
-                if (!mm_in_box[j]) continue;
-                if (lev_slice[j] < vmin) vmin = lev_slice[j];
-                if (lev_slice[j] > vmax) vmax = lev_slice[j];
-            }
-            free(mm_in_box);
-            free(lev_slice);
+            /* Scan only the boxes crossing the plane; gaps hold no data */
+            level_slice_range(ld, pf->current_var, pf->slice_axis,
+                              lev_slice_idx + ld->level_lo[pf->slice_axis], &vmin, &vmax);
         }
     }
 
@@ -3519,9 +8709,17 @@ void render_slice(PlotfileData *pf) {
     current_vmin = display_vmin;
     current_vmax = display_vmax;
 
-    /* Clear canvas with white background */
+    /* The frame is composed in the back buffer and shown with one copy.
+     * Clear it with white background. */
     XSetForeground(display, gc, WhitePixel(display, screen));
-    XFillRectangle(display, canvas, gc, 0, 0, canvas_width, canvas_height);
+    XFillRectangle(display, pixmap, gc, 0, 0, canvas_width, canvas_height);
+
+    unsigned long *cells = cell_pixels((size_t)width * height);
+    if (!cells) {
+        fprintf(stderr, "Error: Cannot allocate pixels for a %d x %d slice\n", width, height);
+        if (base_in_box) free(base_in_box);
+        return;
+    }
 
     /* Declare rendering variables */
     int offset_x, offset_y, local_render_width, local_render_height;
@@ -3531,8 +8729,9 @@ void render_slice(PlotfileData *pf) {
         
         int lon_idx = find_variable_index(pf, "lon_m");
         int lat_idx = find_variable_index(pf, "lat_m");
+        int geo_vars[2] = {lon_idx, lat_idx};
         
-        if (lon_idx >= 0 && lat_idx >= 0) {
+        if (lon_idx >= 0 && lat_idx >= 0 && load_resident_fields(pf, geo_vars, 2) == 0) {
             /* Determine which geographic coordinate to use based on slice axis */
             double *x_geo_slice, *y_coord_slice;  /* Geographic x-axis and actual y-coordinate */
             double *x_geo_extent, *y_coord_extent;
@@ -3546,12 +8745,8 @@ void render_slice(PlotfileData *pf) {
                 y_coord_extent = y_coord_slice;
                 x_label = "lon_m"; y_label = "lat_m";
                 
-                int prev_var = pf->current_var;
-                read_variable_data(pf, lon_idx);
-                extract_slice_from_data(pf->data, pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
-                read_variable_data(pf, lat_idx);
-                extract_slice_from_data(pf->data, pf, y_coord_slice, pf->slice_axis, pf->slice_idx);
-                read_variable_data(pf, prev_var);
+                extract_slice_from_data(resident_field(pf, lon_idx), pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
+                extract_slice_from_data(resident_field(pf, lat_idx), pf, y_coord_slice, pf->slice_axis, pf->slice_idx);
             } else if (pf->slice_axis == 1) {
                 /* Y-slice: longitude as x, Z as y */
                 x_geo_slice = (double *)malloc(width * height * sizeof(double));
@@ -3560,10 +8755,7 @@ void render_slice(PlotfileData *pf) {
                 y_coord_extent = y_coord_slice;
                 x_label = "lon_m"; y_label = "Z";
                 
-                int prev_var = pf->current_var;
-                read_variable_data(pf, lon_idx);
-                extract_slice_from_data(pf->data, pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
-                read_variable_data(pf, prev_var);
+                extract_slice_from_data(resident_field(pf, lon_idx), pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
                 
                 /* Generate Z coordinates for this slice */
                 for (j = 0; j < height; j++) {
@@ -3582,10 +8774,7 @@ void render_slice(PlotfileData *pf) {
                 y_coord_extent = y_coord_slice;
                 x_label = "lat_m"; y_label = "Z";
                 
-                int prev_var = pf->current_var;
-                read_variable_data(pf, lat_idx);
-                extract_slice_from_data(pf->data, pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
-                read_variable_data(pf, prev_var);
+                extract_slice_from_data(resident_field(pf, lat_idx), pf, x_geo_slice, pf->slice_axis, pf->slice_idx);
                 
                 /* Generate Z coordinates for this slice */
                 for (j = 0; j < height; j++) {
@@ -3642,9 +8831,10 @@ void render_slice(PlotfileData *pf) {
             offset_x = left_margin;
             offset_y = top_margin;
             
-            /* Create pixel data for individual points */
-            unsigned long *point_pixels = (unsigned long *)malloc(width * height * sizeof(unsigned long));
-            apply_colormap(slice, width, height, point_pixels, display_vmin, display_vmax, pf->colormap);
+            /* Colour the points, then rasterize them over the white data area */
+            apply_colormap(slice, width, height, cells, display_vmin, display_vmax, pf->colormap);
+            image_fill_rect(offset_x - 1, offset_y - 1, local_render_width + 3,
+                            local_render_height + 3, WhitePixel(display, screen));
             
             /* Render each data point at its coordinate */
             for (j = 0; j < height; j++) {
@@ -3659,15 +8849,13 @@ void render_slice(PlotfileData *pf) {
                         int screen_y = offset_y + (int)((phys_ymax - y_coord) / (phys_ymax - phys_ymin) * local_render_height);
                         
                         /* Draw a small rectangle for each data point */
-                        XSetForeground(display, gc, point_pixels[idx]);
-                        XFillRectangle(display, canvas, gc, screen_x - 1, screen_y - 1, 3, 3);
+                        image_fill_rect(screen_x - 1, screen_y - 1, 3, 3, cells[idx]);
                     }
                 }
             }
             
             free(x_geo_slice);
             free(y_coord_slice);
-            free(point_pixels);
         } else {
             /* Fallback to normal rendering if lon/lat not available */
             phys_xmin = pf->prob_lo[x_axis];
@@ -3676,7 +8864,7 @@ void render_slice(PlotfileData *pf) {
             phys_ymax = pf->prob_hi[y_axis];
             
             /* Use normal rendering code */
-            apply_colormap(slice, width, height, pixel_data, display_vmin, display_vmax, pf->colormap);
+            apply_colormap(slice, width, height, cells, display_vmin, display_vmax, pf->colormap);
 
             int avail_width = canvas_width - left_margin - right_margin;
             int avail_height = canvas_height - top_margin - bottom_margin;
@@ -3699,28 +8887,12 @@ void render_slice(PlotfileData *pf) {
             double pixel_width = (double)local_render_width / width;
             double pixel_height = (double)local_render_height / height;
 
-            for (j = 0; j < height; j++) {
-                for (i = 0; i < width; i++) {
-                    if (base_in_box && !base_in_box[j * width + i]) continue;
-
-                    unsigned long pixel = pixel_data[j * width + i];
-                    XSetForeground(display, gc, pixel);
-
-                    int x = offset_x + (int)(i * pixel_width);
-                    int flipped_j = height - 1 - j;
-                    int y = offset_y + (int)(flipped_j * pixel_height);
-                    int w = (int)((i + 1) * pixel_width) - (int)(i * pixel_width);
-                    int h = (int)((flipped_j + 1) * pixel_height) - (int)(flipped_j * pixel_height);
-                    if (w < 1) w = 1;
-                    if (h < 1) h = 1;
-
-                    XFillRectangle(display, canvas, gc, x, y, w, h);
-                }
-            }
+            put_cell_image(cells, base_in_box, width, height, 0, 0, height,
+                           offset_x, offset_y, pixel_width, pixel_height);
         }
     } else {
         /* Normal mode: apply colormap and render as regular grid */
-        apply_colormap(slice, width, height, pixel_data, display_vmin, display_vmax, pf->colormap);
+        apply_colormap(slice, width, height, cells, display_vmin, display_vmax, pf->colormap);
 
         /* Available area for data (excluding margins) */
         int avail_width = canvas_width - left_margin - right_margin;
@@ -3744,29 +8916,13 @@ void render_slice(PlotfileData *pf) {
             offset_y = top_margin;
         }
 
-        /* Draw pixels as filled rectangles with correct aspect ratio */
+        /* Rasterize the cells with correct aspect ratio; higher j (higher y
+         * in data) is at the top of the screen */
         double pixel_width = (double)local_render_width / width;
         double pixel_height = (double)local_render_height / height;
 
-        for (j = 0; j < height; j++) {
-            for (i = 0; i < width; i++) {
-                if (base_in_box && !base_in_box[j * width + i]) continue;
-
-                unsigned long pixel = pixel_data[j * width + i];
-                XSetForeground(display, gc, pixel);
-
-                int x = offset_x + (int)(i * pixel_width);
-                /* Flip y-axis: higher j (higher y in data) should be at top of screen */
-                int flipped_j = height - 1 - j;
-                int y = offset_y + (int)(flipped_j * pixel_height);
-                int w = (int)((i + 1) * pixel_width) - (int)(i * pixel_width);
-                int h = (int)((flipped_j + 1) * pixel_height) - (int)(flipped_j * pixel_height);
-                if (w < 1) w = 1;
-                if (h < 1) h = 1;
-
-                XFillRectangle(display, canvas, gc, x, y, w, h);
-            }
-        }
+        put_cell_image(cells, base_in_box, width, height, 0, 0, height,
+                       offset_x, offset_y, pixel_width, pixel_height);
     }
 
     /* Store rendering parameters for mouse interaction */
@@ -3891,44 +9047,21 @@ void render_slice(PlotfileData *pf) {
                 continue;  /* Slice not in this level */
             }
 
-            /* Extract slice from this level */
-            double *level_slice = (double *)malloc(lwidth * lheight * sizeof(double));
-            extract_slice_level(ld, level_slice, pf->slice_axis, level_slice_idx);
-
-            /* Build mask: only render cells that fall inside an actual box.
-             * Gaps between non-contiguous boxes are left unmasked (0) so the
-             * underlying coarser level shows through. */
-            unsigned char *in_box = (unsigned char *)calloc(lwidth * lheight, 1);
+            /* Boxes crossing the plane. Only these are drawn, so gaps between
+             * non-contiguous boxes let the underlying coarser level show through. */
+            int *hits = (int *)malloc((ld->n_boxes > 0 ? ld->n_boxes : 1) * sizeof(int));
             int slice_coord = level_slice_idx + ld->level_lo[pf->slice_axis];
-            for (int bi = 0; bi < ld->n_boxes; bi++) {
-                Box *box = &ld->boxes[bi];
-                /* Check if this box intersects the current slice */
-                if (slice_coord < box->lo[pf->slice_axis] || slice_coord > box->hi[pf->slice_axis])
-                    continue;
-                /* Determine the 2D range this box covers in the slice plane */
-                int dim_x, dim_y;  /* which 3D dims map to li, lj */
-                if (pf->slice_axis == 2) { dim_x = 0; dim_y = 1; }
-                else if (pf->slice_axis == 1) { dim_x = 0; dim_y = 2; }
-                else { dim_x = 1; dim_y = 2; }
-                int li_lo = box->lo[dim_x] - ld->level_lo[dim_x];
-                int li_hi = box->hi[dim_x] - ld->level_lo[dim_x];
-                int lj_lo = box->lo[dim_y] - ld->level_lo[dim_y];
-                int lj_hi = box->hi[dim_y] - ld->level_lo[dim_y];
-                /* Clamp to grid bounds */
-                if (li_lo < 0) li_lo = 0;
-                if (lj_lo < 0) lj_lo = 0;
-                if (li_hi >= lwidth) li_hi = lwidth - 1;
-                if (lj_hi >= lheight) lj_hi = lheight - 1;
-                for (int mj = lj_lo; mj <= lj_hi; mj++) {
-                    for (int mi = li_lo; mi <= li_hi; mi++) {
-                        in_box[mj * lwidth + mi] = 1;
-                    }
-                }
+            int n_hits = box_index_plane(&ld->box_index, ld->boxes, pf->slice_axis, slice_coord, hits);
+
+            /* Patch buffers sized for the largest crossing box */
+            size_t max_area = 1;
+            for (int h = 0; h < n_hits; h++) {
+                int pw, ph;
+                box_plane_dims(&ld->boxes[hits[h]], pf->slice_axis, &pw, &ph);
+                if ((size_t)pw * ph > max_area) max_area = (size_t)pw * ph;
             }
-
-            /* Apply colormap to level slice */
-            unsigned long *level_pixels = (unsigned long *)malloc(lwidth * lheight * sizeof(unsigned long));
-            apply_colormap(level_slice, lwidth, lheight, level_pixels, display_vmin, display_vmax, pf->colormap);
+            double *patch = (double *)malloc(max_area * sizeof(double));
+            unsigned long *patch_pixels = (unsigned long *)malloc(max_area * sizeof(unsigned long));
 
             /* Map level physical bounds to screen coordinates */
             double frac_x_lo = (level_x_lo - phys_xmin) / (phys_xmax - phys_xmin);
@@ -3944,32 +9077,27 @@ void render_slice(PlotfileData *pf) {
             double lpixel_width = (double)(screen_x1 - screen_x0) / lwidth;
             double lpixel_height = (double)(screen_y1 - screen_y0) / lheight;
 
-            /* Draw level pixels, skipping cells not inside any box */
-            for (int lj = 0; lj < lheight; lj++) {
-                for (int li = 0; li < lwidth; li++) {
-                    if (!in_box[lj * lwidth + li]) continue;
-
-                    unsigned long pixel = level_pixels[lj * lwidth + li];
-                    XSetForeground(display, gc, pixel);
-
-                    int lx = screen_x0 + (int)(li * lpixel_width);
-                    int flipped_lj = lheight - 1 - lj;
-                    int ly = screen_y0 + (int)(flipped_lj * lpixel_height);
-                    int lw = (int)((li + 1) * lpixel_width) - (int)(li * lpixel_width);
-                    int lh = (int)((flipped_lj + 1) * lpixel_height) - (int)(flipped_lj * lpixel_height);
-                    if (lw < 1) lw = 1;
-                    if (lh < 1) lh = 1;
-
-                    XFillRectangle(display, canvas, gc, lx, ly, lw, lh);
-                }
+            /* Draw each crossing box from its own array, at its place in the level */
+            int dim_px = (pf->slice_axis == 0) ? 1 : 0;
+            int dim_py = (pf->slice_axis == 2) ? 1 : 2;
+            for (int h = 0; h < n_hits && patch && patch_pixels; h++) {
+                const Box *box = &ld->boxes[hits[h]];
+                int pw, ph;
+                box_plane_dims(box, pf->slice_axis, &pw, &ph);
+                extract_level_box_plane(ld, hits[h], pf->slice_axis, slice_coord, patch);
+                apply_colormap(patch, pw, ph, patch_pixels, display_vmin, display_vmax, pf->colormap);
+
+                /* Boxes lie inside their level, so the whole patch is drawn */
+                int li0 = box->lo[dim_px] - ld->level_lo[dim_px];
+                int lj0 = box->lo[dim_py] - ld->level_lo[dim_py];
+                put_cell_image(patch_pixels, NULL, pw, ph, li0, lj0, lheight,
+                               screen_x0, screen_y0, lpixel_width, lpixel_height);
             }
 
-            /* Draw box outlines for each actual box at this level */
-            XSetForeground(display, gc, 0xFF0000);  /* Red */
-            for (int bi = 0; bi < ld->n_boxes; bi++) {
-                Box *box = &ld->boxes[bi];
-                if (slice_coord < box->lo[pf->slice_axis] || slice_coord > box->hi[pf->slice_axis])
-                    continue;
+            /* Outline each actual box at this level in the frame image, so
+             * finer levels drawn later cover it as their cells do */
+            for (int h = 0; h < n_hits; h++) {
+                Box *box = &ld->boxes[hits[h]];
                 int dim_x, dim_y;
                 if (pf->slice_axis == 2) { dim_x = 0; dim_y = 1; }
                 else if (pf->slice_axis == 1) { dim_x = 0; dim_y = 2; }
@@ -3986,22 +9114,28 @@ void render_slice(PlotfileData *pf) {
                 int bsx1 = offset_x + (int)(bfx_hi * render_width);
                 int bsy0 = offset_y + local_render_height - (int)(bfy_hi * local_render_height);
                 int bsy1 = offset_y + local_render_height - (int)(bfy_lo * local_render_height);
-                XDrawRectangle(display, canvas, gc, bsx0, bsy0, bsx1 - bsx0, bsy1 - bsy0);
+                unsigned long red = 0xFF0000;
+                image_fill_rect(bsx0, bsy0, bsx1 - bsx0 + 1, 1, red);
+                image_fill_rect(bsx0, bsy1, bsx1 - bsx0 + 1, 1, red);
+                image_fill_rect(bsx0, bsy0, 1, bsy1 - bsy0 + 1, red);
+                image_fill_rect(bsx1, bsy0, 1, bsy1 - bsy0 + 1, red);
             }
 
-            free(in_box);
-
-            free(level_slice);
-            free(level_pixels);
+            free(hits);
+            free(patch);
+            free(patch_pixels);
 
             printf("Overlay level %d: slice %d, screen [%d,%d]-[%d,%d]\n",
                    level, level_slice_idx, screen_x0, screen_y0, screen_x1, screen_y1);
         }
     }
 
+    /* Send the data area, overlays included, with one put */
+    image_flush(offset_x - 1, offset_y - 1, local_render_width + 3, local_render_height + 3);
+
     /* Draw axis frame (border around data) */
     XSetForeground(display, text_gc, BlackPixel(display, screen));
-    XDrawRectangle(display, canvas, text_gc, offset_x, offset_y, local_render_width, local_render_height);
+    XDrawRectangle(display, pixmap, text_gc, offset_x, offset_y, local_render_width, local_render_height);
 
     /* Draw X-axis ticks and labels */
     int n_xticks = 5;
@@ -4012,13 +9146,13 @@ void render_slice(PlotfileData *pf) {
         double phys_val = phys_xmin + frac * (phys_xmax - phys_xmin);
 
         /* Draw tick mark */
-        XDrawLine(display, canvas, text_gc, tick_x, offset_y + local_render_height,
+        XDrawLine(display, pixmap, text_gc, tick_x, offset_y + local_render_height,
               tick_x, offset_y + local_render_height + 5);
 
         /* Draw label */
         snprintf(label, sizeof(label), "%.3g", phys_val);
         int label_width = XTextWidth(font, label, strlen(label));
-        XDrawString(display, canvas, text_gc, tick_x - label_width / 2,
+        XDrawString(display, pixmap, text_gc, tick_x - label_width / 2,
                 offset_y + local_render_height + 18, label, strlen(label));
     }
 
@@ -4030,12 +9164,12 @@ void render_slice(PlotfileData *pf) {
         double phys_val = phys_ymin + frac * (phys_ymax - phys_ymin);
 
         /* Draw tick mark */
-        XDrawLine(display, canvas, text_gc, offset_x - 5, tick_y, offset_x, tick_y);
+        XDrawLine(display, pixmap, text_gc, offset_x - 5, tick_y, offset_x, tick_y);
 
         /* Draw label */
         snprintf(label, sizeof(label), "%.3g", phys_val);
         int label_width = XTextWidth(font, label, strlen(label));
-        XDrawString(display, canvas, text_gc, offset_x - label_width - 8,
+        XDrawString(display, pixmap, text_gc, offset_x - label_width - 8,
                     tick_y + 4, label, strlen(label));
     }
 
@@ -4056,12 +9190,12 @@ void render_slice(PlotfileData *pf) {
 
     /* X-axis label (centered below ticks) */
     int xlabel_width = XTextWidth(font, x_label, strlen(x_label));
-    XDrawString(display, canvas, text_gc,
+    XDrawString(display, pixmap, text_gc,
                 offset_x + local_render_width / 2 - xlabel_width / 2,
                 offset_y + local_render_height + 35, x_label, strlen(x_label));
 
     /* Y-axis label (rotated text is hard in X11, so just draw at left) */
-    XDrawString(display, canvas, text_gc, 5,
+    XDrawString(display, pixmap, text_gc, 5,
                 offset_y + local_render_height / 2 + 4, y_label, strlen(y_label));
 
     /* Draw text overlay - show display range (custom if set) */
@@ -4072,7 +9206,7 @@ void render_slice(PlotfileData *pf) {
     }
     XSetForeground(display, text_gc, BlackPixel(display, screen));
     XSetBackground(display, text_gc, WhitePixel(display, screen));
-    XDrawImageString(display, canvas, text_gc, left_margin, canvas_height - 5,
+    XDrawImageString(display, pixmap, text_gc, left_margin, canvas_height - 5,
                     stats_text, strlen(stats_text));
 
     /* Draw colorbar */
@@ -4089,13 +9223,15 @@ void render_slice(PlotfileData *pf) {
         render_map_overlay(pf, phys_xmin, phys_xmax, phys_ymin, phys_ymax);
     }
 
+    /* Show the finished frame */
+    XCopyArea(display, pixmap, canvas, gc, 0, 0, canvas_width, canvas_height, 0, 0);
+    frame_valid = 1;
     XFlush(display);
     
     printf("Rendered: %s, slice %d/%d (%.3e to %.3e)\n", 
            pf->variables[pf->current_var], pf->slice_idx + 1,
            pf->grid_dims[pf->slice_axis], vmin, vmax);
     
-    free(slice);
     if (base_in_box) free(base_in_box);
 }
 
@@ -4124,8 +9260,24 @@ void canvas_motion_handler(Widget w, XtPointer client_data, XEvent *event, Boole
     if (data_x >= 0 && data_x < slice_width && data_y >= 0 && data_y < slice_height) {
         double value = current_slice_data[data_y * slice_width + data_x];
         
+        /* Refined levels can have gaps between boxes; they hold no data */
+        int in_gap = 0;
+        if (global_pf->current_level > 0) {
+            int axis = global_pf->slice_axis;
+            int cell[3];
+            cell[axis] = global_pf->slice_idx;
+            cell[axis == 0 ? 1 : 0] = data_x;
+            cell[axis == 2 ? 1 : 2] = data_y;
+            for (int d = 0; d < 3; d++) cell[d] += global_pf->level_lo[d];
+            in_gap = box_index_find(&global_pf->box_index, global_pf->boxes, cell) < 0;
+        }
+
         /* Update hover value text and info label */
-        snprintf(hover_value_text, sizeof(hover_value_text), "[%d,%d]: %.6e", data_x, data_y, value);
+        if (in_gap) {
+            snprintf(hover_value_text, sizeof(hover_value_text), "[%d,%d]: no data", data_x, data_y);
+        } else {
+            snprintf(hover_value_text, sizeof(hover_value_text), "[%d,%d]: %.6e", data_x, data_y, value);
+        }
         update_info_label(global_pf);
     }
 }
@@ -4427,6 +9579,29 @@ void close_popup_callback(Widget w, XtPointer client_data, XtPointer call_data)
 }
 
 /* Show 1D line profiles through clicked point along x, y, z */
+/* Read plane (axis, idx) of the current variable into a caller buffer,
+ * leaving the plane kept for display alone. Without a full field it comes
+ * from the sidecar, the out-of-core chunk or the crossing boxes. */
+static int read_profile_plane(PlotfileData *pf, int axis, int idx, double *plane) {
+    char level_dir[MAX_PATH];
+
+    if (pf->data) {
+        extract_field_plane(pf->data, pf->grid_dims, plane, axis, idx);
+        return 0;
+    }
+    if (slice_cache_read(pf, pf->current_var, axis, idx, plane) == 0) return 0;
+    if (ooc_mb > 0 && axis == 2) {
+        const OocChunk *oc = ooc_chunk(pf, pf->current_var, idx);
+        if (oc) {
+            extract_field_plane(oc->data, oc->dims, plane, 2, idx - oc->z0);
+            return 0;
+        }
+    }
+    if (level_dir_path(level_dir, pf->plotfile_dir, pf->current_level) < 0) return -1;
+    return read_fab_plane(level_dir, pf->boxes, pf->n_boxes, pf->current_var,
+                          axis, idx, plane, pf->grid_dims, pf->level_lo) < 0 ? -1 : 0;
+}
+
 void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
     /* Get 3D coordinates based on current slice */
     int x_coord, y_coord, z_coord;
@@ -4444,6 +9619,19 @@ void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
         y_coord = data_x;
         z_coord = data_y;
     }
+
+    /* The X and Y lines lie in Z plane z_coord and the Z line in Y plane
+     * y_coord, so two planes serve all three without the full field */
+    int nx = pf->grid_dims[0], ny = pf->grid_dims[1], nz = pf->grid_dims[2];
+    double *z_plane = (double *)malloc((size_t)nx * ny * sizeof(double));
+    double *y_plane = (double *)malloc((size_t)nx * nz * sizeof(double));
+    if (!z_plane || !y_plane ||
+        read_profile_plane(pf, 2, z_coord, z_plane) < 0 ||
+        read_profile_plane(pf, 1, y_coord, y_plane) < 0) {
+        free(z_plane);
+        free(y_plane);
+        return;
+    }
     
     /* Create plot data structures */
     PlotData *x_plot_data = (PlotData *)malloc(sizeof(PlotData));
@@ -4458,8 +9646,7 @@ void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
     x_plot_data->vmax = -1e30;
     for (int i = 0; i < pf->grid_dims[0]; i++) {
         x_plot_data->x_values[i] = i;
-        int idx = z_coord * pf->grid_dims[0] * pf->grid_dims[1] + y_coord * pf->grid_dims[0] + i;
-        x_plot_data->data[i] = pf->data[idx];
+        x_plot_data->data[i] = z_plane[(size_t)y_coord * nx + i];
         if (x_plot_data->data[i] < x_plot_data->vmin) x_plot_data->vmin = x_plot_data->data[i];
         if (x_plot_data->data[i] > x_plot_data->vmax) x_plot_data->vmax = x_plot_data->data[i];
     }
@@ -4477,8 +9664,7 @@ void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
     y_plot_data->vmax = -1e30;
     for (int j = 0; j < pf->grid_dims[1]; j++) {
         y_plot_data->x_values[j] = j;
-        int idx = z_coord * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + x_coord;
-        y_plot_data->data[j] = pf->data[idx];
+        y_plot_data->data[j] = z_plane[(size_t)j * nx + x_coord];
         if (y_plot_data->data[j] < y_plot_data->vmin) y_plot_data->vmin = y_plot_data->data[j];
         if (y_plot_data->data[j] > y_plot_data->vmax) y_plot_data->vmax = y_plot_data->data[j];
     }
@@ -4496,8 +9682,7 @@ void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
     z_plot_data->vmax = -1e30;
     for (int k = 0; k < pf->grid_dims[2]; k++) {
         z_plot_data->x_values[k] = k;
-        int idx = k * pf->grid_dims[0] * pf->grid_dims[1] + y_coord * pf->grid_dims[0] + x_coord;
-        z_plot_data->data[k] = pf->data[idx];
+        z_plot_data->data[k] = y_plane[(size_t)k * nx + x_coord];
         if (z_plot_data->data[k] < z_plot_data->vmin) z_plot_data->vmin = z_plot_data->data[k];
         if (z_plot_data->data[k] > z_plot_data->vmax) z_plot_data->vmax = z_plot_data->data[k];
     }
@@ -4506,6 +9691,8 @@ void show_line_profiles(PlotfileData *pf, int data_x, int data_y) {
     snprintf(z_plot_data->title, sizeof(z_plot_data->title), "%s along Z (X=%d, Y=%d)", 
              pf->variables[pf->current_var], x_coord, y_coord);
     snprintf(z_plot_data->xlabel, sizeof(z_plot_data->xlabel), "Z");
+    free(z_plane);
+    free(y_plane);
     
     /* Create popup data structure */
     PopupData *popup_data = (PopupData *)malloc(sizeof(PopupData));
@@ -4619,80 +9806,46 @@ void show_slice_statistics(PlotfileData *pf) {
     int axis = pf->slice_axis;
     int n_slices = pf->grid_dims[axis];
 
-    /* Determine slice dimensions */
-    int slice_dim1, slice_dim2;
-    if (axis == 2) {  /* Z slices: X-Y planes */
-        slice_dim1 = pf->grid_dims[0];
-        slice_dim2 = pf->grid_dims[1];
-    } else if (axis == 1) {  /* Y slices: X-Z planes */
-        slice_dim1 = pf->grid_dims[0];
-        slice_dim2 = pf->grid_dims[2];
-    } else {  /* X slices: Y-Z planes */
-        slice_dim1 = pf->grid_dims[1];
-        slice_dim2 = pf->grid_dims[2];
+    /* Per-layer moments from the statistics cache, computed from the full
+     * field (streamed in chunks out of core) only when some layer is missing */
+    const char *var = pf->variables[pf->current_var];
+    double *moments = (double *)malloc((size_t)n_slices * STATS_MOMENTS * sizeof(double));
+    if (!moments) return;
+    const StatsEntry *se = stats_cache_lookup(pf->plotfile_dir, pf->current_level, var, axis);
+    int cached = se && se->n_layers == n_slices;
+    for (int s = 0; cached && s < n_slices; s++) {
+        if (isnan(se->moments[(size_t)s * STATS_MOMENTS])) cached = 0;
+    }
+    if (cached) {
+        memcpy(moments, se->moments, (size_t)n_slices * STATS_MOMENTS * sizeof(double));
+        printf("Profile: %s along %s from the statistics cache\n", var, axis_names[axis]);
+    } else {
+        int failed;
+        if (!pf->data && ooc_mb > 0) {
+            failed = ooc_layer_moments(pf, pf->current_var, axis, moments) < 0;
+        } else {
+            failed = ensure_full_data(pf) < 0 ||
+                     field_layer_moments(pf->data, pf->grid_dims, axis, moments) < 0;
+        }
+        if (failed) {
+            free(moments);
+            return;
+        }
+        stats_cache_store(pf->plotfile_dir, pf->current_level, var, axis, n_slices, moments);
     }
-    int slice_size = slice_dim1 * slice_dim2;
 
-    /* Allocate arrays for mean, std, and skewness */
+    /* Split into mean, std, and skewness arrays */
     double *means = (double *)malloc(n_slices * sizeof(double));
     double *stds = (double *)malloc(n_slices * sizeof(double));
     double *skewness = (double *)malloc(n_slices * sizeof(double));
     double *layer_indices = (double *)malloc(n_slices * sizeof(double));
-
-    /* Calculate mean, std, and skewness for each slice */
     for (int s = 0; s < n_slices; s++) {
         layer_indices[s] = s + 1;  /* 1-indexed for display */
-
-        double sum = 0.0;
-        double sum_sq = 0.0;
-
-        /* First pass: calculate mean and variance */
-        for (int j = 0; j < slice_dim2; j++) {
-            for (int i = 0; i < slice_dim1; i++) {
-                int idx;
-                if (axis == 2) {  /* Z slice */
-                    idx = s * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + i;
-                } else if (axis == 1) {  /* Y slice */
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + s * pf->grid_dims[0] + i;
-                } else {  /* X slice */
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + i * pf->grid_dims[0] + s;
-                }
-                double val = pf->data[idx];
-                sum += val;
-                sum_sq += val * val;
-            }
-        }
-
-        means[s] = sum / slice_size;
-        double variance = (sum_sq / slice_size) - (means[s] * means[s]);
-        stds[s] = (variance > 0) ? sqrt(variance) : 0.0;
-
-        /* Second pass: calculate skewness (third moment) */
-        double sum_third = 0.0;
-        for (int j = 0; j < slice_dim2; j++) {
-            for (int i = 0; i < slice_dim1; i++) {
-                int idx;
-                if (axis == 2) {  /* Z slice */
-                    idx = s * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + i;
-                } else if (axis == 1) {  /* Y slice */
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + s * pf->grid_dims[0] + i;
-                } else {  /* X slice */
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + i * pf->grid_dims[0] + s;
-                }
-                double val = pf->data[idx];
-                double diff = val - means[s];
-                sum_third += diff * diff * diff;
-            }
-        }
-
-        /* Skewness = E[(X - mu)^3] / sigma^3 */
-        if (stds[s] > 0) {
-            double std3 = stds[s] * stds[s] * stds[s];
-            skewness[s] = (sum_third / slice_size) / std3;
-        } else {
-            skewness[s] = 0.0;
-        }
+        means[s] = moments[(size_t)s * STATS_MOMENTS];
+        stds[s] = moments[(size_t)s * STATS_MOMENTS + 1];
+        skewness[s] = moments[(size_t)s * STATS_MOMENTS + 2];
     }
+    free(moments);
 
     /* Create plot data for mean */
     PlotData *mean_plot = (PlotData *)malloc(sizeof(PlotData));
@@ -4813,7 +9966,7 @@ void show_slice_statistics(PlotfileData *pf) {
 
 /* Profile button callback */
 void profile_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf && global_pf->data) {
+    if (global_pf && field_available(global_pf)) {
         show_slice_statistics(global_pf);
     }
 }
@@ -5183,29 +10336,19 @@ void show_distribution(PlotfileData *pf) {
     }
     int slice_size = slice_dim1 * slice_dim2;
 
-    /* Extract slice data and calculate statistics */
+    /* Extract slice data and calculate statistics. Only the plane is
+     * needed, so slice and out-of-core modes never load the full field. */
     double *slice_data = (double *)malloc(slice_size * sizeof(double));
     double sum = 0.0, sum_sq = 0.0;
     double data_min = 1e30, data_max = -1e30;
 
-    int k = 0;
-    for (int j = 0; j < slice_dim2; j++) {
-        for (int i = 0; i < slice_dim1; i++) {
-            int idx;
-            if (axis == 2) {
-                idx = slice_idx * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + i;
-            } else if (axis == 1) {
-                idx = j * pf->grid_dims[0] * pf->grid_dims[1] + slice_idx * pf->grid_dims[0] + i;
-            } else {
-                idx = j * pf->grid_dims[0] * pf->grid_dims[1] + i * pf->grid_dims[0] + slice_idx;
-            }
-            double val = pf->data[idx];
-            slice_data[k++] = val;
-            sum += val;
-            sum_sq += val * val;
-            if (val < data_min) data_min = val;
-            if (val > data_max) data_max = val;
-        }
+    extract_slice(pf, slice_data, axis, slice_idx);
+    for (int k = 0; k < slice_size; k++) {
+        double val = slice_data[k];
+        sum += val;
+        sum_sq += val * val;
+        if (val < data_min) data_min = val;
+        if (val > data_max) data_max = val;
     }
 
     /* Calculate mean and std */
@@ -5308,7 +10451,7 @@ void show_distribution(PlotfileData *pf) {
 
 /* Distribution button callback */
 void distribution_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf && global_pf->data) {
+    if (global_pf && field_available(global_pf)) {
         show_distribution(global_pf);
     }
 }
@@ -5394,7 +10537,7 @@ void get_default_quiver_components(PlotfileData *pf, char *x_comp, char *y_comp)
 
 /* Quiver button callback */
 void quiver_button_callback(Widget w, XtPointer client_data, XtPointer call_data) {
-    if (global_pf && global_pf->data) {
+    if (global_pf && field_available(global_pf)) {
         /* Get default component names and enable quiver immediately */
         char default_x[64], default_y[64];
         get_default_quiver_components(global_pf, default_x, default_y);
@@ -5833,24 +10976,18 @@ void render_quiver_overlay(PlotfileData *pf) {
         height = pf->grid_dims[2];
     }
     
-    /* Read component data */
-    double *x_comp_data = (double *)malloc(pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2] * sizeof(double));
-    double *y_comp_data = (double *)malloc(pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2] * sizeof(double));
-    
-    /* Save current variable and read component data */
-    int saved_var = pf->current_var;
-    
-    pf->current_var = quiver_data.x_comp_index;
-    read_variable_data(pf, quiver_data.x_comp_index);
-    memcpy(x_comp_data, pf->data, pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2] * sizeof(double));
-    
-    pf->current_var = quiver_data.y_comp_index;
-    read_variable_data(pf, quiver_data.y_comp_index);
-    memcpy(y_comp_data, pf->data, pf->grid_dims[0] * pf->grid_dims[1] * pf->grid_dims[2] * sizeof(double));
-    
-    /* Restore original variable */
-    pf->current_var = saved_var;
-    read_variable_data(pf, saved_var);
+    /* Component (and map coordinate) fields stay resident between redraws;
+     * whatever is missing is read in one pass */
+    int lon_idx = -1, lat_idx = -1;
+    if (pf->map_mode && map_has_bounds) {
+        lon_idx = find_variable_index(pf, "lon_m");
+        lat_idx = find_variable_index(pf, "lat_m");
+    }
+    int comp_vars[4] = {quiver_data.x_comp_index, quiver_data.y_comp_index, lon_idx, lat_idx};
+    if (load_resident_fields(pf, comp_vars, 4) < 0) return;
+    void *x_comp_data = resident_field(pf, quiver_data.x_comp_index);
+    void *y_comp_data = resident_field(pf, quiver_data.y_comp_index);
+    if (!x_comp_data || !y_comp_data) return;
     
     /* Extract slices for both components */
     double *x_slice = (double *)malloc(width * height * sizeof(double));
@@ -5864,22 +11001,17 @@ void render_quiver_overlay(PlotfileData *pf) {
     double *x_coord_slice = NULL;
     double *y_coord_slice = NULL;
     if (pf->map_mode && map_has_bounds) {
-        int lon_idx = find_variable_index(pf, "lon_m");
-        int lat_idx = find_variable_index(pf, "lat_m");
         if (lon_idx >= 0 && lat_idx >= 0) {
             x_coord_slice = (double *)malloc(width * height * sizeof(double));
             y_coord_slice = (double *)malloc(width * height * sizeof(double));
 
             if (pf->slice_axis == 2) {
                 /* Z-slice: lon/lat */
-                read_variable_data(pf, lon_idx);
-                extract_slice_from_data(pf->data, pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
-                read_variable_data(pf, lat_idx);
-                extract_slice_from_data(pf->data, pf, y_coord_slice, pf->slice_axis, pf->slice_idx);
+                extract_slice_from_data(resident_field(pf, lon_idx), pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
+                extract_slice_from_data(resident_field(pf, lat_idx), pf, y_coord_slice, pf->slice_axis, pf->slice_idx);
             } else if (pf->slice_axis == 1) {
                 /* Y-slice: lon vs Z */
-                read_variable_data(pf, lon_idx);
-                extract_slice_from_data(pf->data, pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
+                extract_slice_from_data(resident_field(pf, lon_idx), pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
                 for (int jj = 0; jj < height; jj++) {
                     for (int ii = 0; ii < width; ii++) {
                         int idx = jj * width + ii;
@@ -5889,8 +11021,7 @@ void render_quiver_overlay(PlotfileData *pf) {
                 }
             } else {
                 /* X-slice: lat vs Z */
-                read_variable_data(pf, lat_idx);
-                extract_slice_from_data(pf->data, pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
+                extract_slice_from_data(resident_field(pf, lat_idx), pf, x_coord_slice, pf->slice_axis, pf->slice_idx);
                 for (int jj = 0; jj < height; jj++) {
                     for (int ii = 0; ii < width; ii++) {
                         int idx = jj * width + ii;
@@ -5900,8 +11031,6 @@ void render_quiver_overlay(PlotfileData *pf) {
                 }
             }
 
-            /* Restore current variable */
-            read_variable_data(pf, saved_var);
             use_map_coords = 1;
         }
     }
@@ -5914,8 +11043,6 @@ void render_quiver_overlay(PlotfileData *pf) {
     }
     
     if (max_mag == 0.0) {
-        free(x_comp_data);
-        free(y_comp_data);
         free(x_slice);
         free(y_slice);
         return;
@@ -6033,14 +11160,12 @@ void render_quiver_overlay(PlotfileData *pf) {
                 arrow_dy = (int)(-v * scale);  /* Flip Y to match screen coordinates */
             }
             
-            draw_arrow(display, canvas, gc, screen_x, screen_y, 
+            draw_arrow(display, pixmap, gc, screen_x, screen_y, 
                       screen_x + arrow_dx, screen_y + arrow_dy);
         }
     }
     
     /* Cleanup */
-    free(x_comp_data);
-    free(y_comp_data);
     free(x_slice);
     free(y_slice);
     if (x_coord_slice) free(x_coord_slice);
@@ -6150,7 +11275,7 @@ static int draw_geojson_coastline(const char *path, double lon_min, double lon_m
                                 int y1 = offset_y + (int)((lat_max - prev_lat) / (lat_max - lat_min) * render_h);
                                 int x2 = offset_x + (int)((lon - lon_min) / (lon_max - lon_min) * render_w);
                                 int y2 = offset_y + (int)((lat_max - lat) / (lat_max - lat_min) * render_h);
-                                XDrawLine(display, canvas, coastline_gc, x1, y1, x2, y2);
+                                XDrawLine(display, pixmap, coastline_gc, x1, y1, x2, y2);
                             }
                         }
                     }
@@ -6205,33 +11330,8 @@ void render_map_overlay(PlotfileData *pf, double lon_min, double lon_max, double
 }
 
 /* Helper function to extract slice from arbitrary data array */
-void extract_slice_from_data(double *data, PlotfileData *pf, double *slice, int axis, int idx) {
-    int width, height;
-    if (axis == 2) {
-        width = pf->grid_dims[0];
-        height = pf->grid_dims[1];
-        for (int j = 0; j < height; j++) {
-            for (int i = 0; i < width; i++) {
-                slice[j * width + i] = data[idx * width * height + j * width + i];
-            }
-        }
-    } else if (axis == 1) {
-        width = pf->grid_dims[0];
-        height = pf->grid_dims[2];
-        for (int k = 0; k < height; k++) {
-            for (int i = 0; i < width; i++) {
-                slice[k * width + i] = data[k * pf->grid_dims[0] * pf->grid_dims[1] + idx * pf->grid_dims[0] + i];
-            }
-        }
-    } else {
-        width = pf->grid_dims[1];
-        height = pf->grid_dims[2];
-        for (int k = 0; k < height; k++) {
-            for (int j = 0; j < width; j++) {
-                slice[k * width + j] = data[k * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + idx];
-            }
-        }
-    }
+void extract_slice_from_data(const void *data, PlotfileData *pf, double *slice, int axis, int idx) {
+    extract_field_plane(data, pf->grid_dims, slice, axis, idx);
 }
 
 /* Popup data for time series (3 plots) */
@@ -6281,100 +11381,118 @@ void show_time_series(PlotfileData *pf) {
     char original_dir[MAX_PATH];
     strncpy(original_dir, pf->plotfile_dir, MAX_PATH - 1);
 
-    /* Determine slice dimensions */
-    int slice_dim1, slice_dim2;
-    if (axis == 2) {
-        slice_dim1 = pf->grid_dims[0];
-        slice_dim2 = pf->grid_dims[1];
-    } else if (axis == 1) {
-        slice_dim1 = pf->grid_dims[0];
-        slice_dim2 = pf->grid_dims[2];
-    } else {
-        slice_dim1 = pf->grid_dims[1];
-        slice_dim2 = pf->grid_dims[2];
-    }
-    int slice_size = slice_dim1 * slice_dim2;
-
     /* Allocate arrays for time series statistics */
     double *means = (double *)malloc(n_timesteps * sizeof(double));
     double *stds = (double *)malloc(n_timesteps * sizeof(double));
     double *skewness = (double *)malloc(n_timesteps * sizeof(double));
     double *time_indices = (double *)malloc(n_timesteps * sizeof(double));
-
-    printf("Computing time series statistics for %d timesteps...\n", n_timesteps);
-
-    /* Loop through all timesteps */
+    int *missing = (int *)malloc(n_timesteps * sizeof(int));
+    int n_missing = 0;
+
+    /* Timesteps whose layer moments are cached need no I/O at all */
+    char var[64];
+    int level = pf->current_level;
+    strncpy(var, pf->variables[current_var], sizeof(var) - 1);
+    var[sizeof(var) - 1] = '\0';
     for (int t = 0; t < n_timesteps; t++) {
+        double m[STATS_MOMENTS];
         time_indices[t] = t + 1;  /* 1-indexed for display */
+        if (stats_cache_layer(timestep_paths[t], level, var, axis, slice_idx, m) == 0) {
+            means[t] = m[0];
+            stds[t] = m[1];
+            skewness[t] = m[2];
+        } else {
+            missing[n_missing++] = t;
+        }
+    }
+    printf("Time series for %d timesteps: %d from the statistics cache, %d to compute\n",
+           n_timesteps, n_timesteps - n_missing, n_missing);
+
+    /* Sequential sweep: ask the kernel to read ahead one timestep and to
+     * drop each timestep's pages once its statistics are done, so a long
+     * sweep does not push everything else out of the page cache */
+    int plane_axis = slice_mode ? axis : -1;
+    size_t advised = 0;
+    sweep_mode = 1;
+    if (n_missing > 0) {
+        advise_timestep_reads(timestep_paths[missing[0]], level, pf->ndim, pf->n_vars,
+                              current_var, plane_axis, slice_idx, POSIX_FADV_WILLNEED);
+    }
+
+    /* Loop through the timesteps still missing */
+    for (int n = 0; n < n_missing; n++) {
+        int t = missing[n];
+
+        if (n + 1 < n_missing) {
+            advise_timestep_reads(timestep_paths[missing[n + 1]], level, pf->ndim, pf->n_vars,
+                                  current_var, plane_axis, slice_idx, POSIX_FADV_WILLNEED);
+        }
 
         /* Load this timestep's data */
         strncpy(pf->plotfile_dir, timestep_paths[t], MAX_PATH - 1);
         read_header(pf);
         pf->n_boxes = 0;
         read_cell_h(pf);
-        read_variable_data(pf, current_var);
-
-        /* Calculate statistics for the slice */
-        double sum = 0.0, sum_sq = 0.0;
-
-        for (int j = 0; j < slice_dim2; j++) {
-            for (int i = 0; i < slice_dim1; i++) {
-                int idx;
-                if (axis == 2) {
-                    idx = slice_idx * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + i;
-                } else if (axis == 1) {
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + slice_idx * pf->grid_dims[0] + i;
-                } else {
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + i * pf->grid_dims[0] + slice_idx;
-                }
-                double val = pf->data[idx];
-                sum += val;
-                sum_sq += val * val;
-            }
+        int n_layers = pf->grid_dims[axis];
+        double *moments = (double *)malloc((size_t)(n_layers > 0 ? n_layers : 1) *
+                                           STATS_MOMENTS * sizeof(double));
+        means[t] = stds[t] = skewness[t] = 0.0;
+        if (!moments || slice_idx >= n_layers) {
+            free(moments);
+            continue;
         }
 
-        means[t] = sum / slice_size;
-        double variance = (sum_sq / slice_size) - (means[t] * means[t]);
-        stds[t] = (variance > 0) ? sqrt(variance) : 0.0;
-
-        /* Second pass: calculate skewness (third moment) */
-        double sum_third = 0.0;
-        for (int j = 0; j < slice_dim2; j++) {
-            for (int i = 0; i < slice_dim1; i++) {
-                int idx;
-                if (axis == 2) {
-                    idx = slice_idx * pf->grid_dims[0] * pf->grid_dims[1] + j * pf->grid_dims[0] + i;
-                } else if (axis == 1) {
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + slice_idx * pf->grid_dims[0] + i;
-                } else {
-                    idx = j * pf->grid_dims[0] * pf->grid_dims[1] + i * pf->grid_dims[0] + slice_idx;
-                }
-                double val = pf->data[idx];
-                double diff = val - means[t];
-                sum_third += diff * diff * diff;
+        if (slice_mode) {
+            /* Only the plane is needed, not the whole field; the other
+             * layers stay uncomputed in the cache */
+            for (size_t i = 0; i < (size_t)n_layers * STATS_MOMENTS; i++) moments[i] = NAN;
+            if (read_variable_slice(pf, current_var, axis, slice_idx) == 0) {
+                size_t n_plane = (size_t)((axis == 0) ? pf->grid_dims[1] : pf->grid_dims[0]) *
+                                 ((axis == 2) ? pf->grid_dims[1] : pf->grid_dims[2]);
+                plane_moments(pf->plane, n_plane, &moments[(size_t)slice_idx * STATS_MOMENTS]);
             }
+        } else if (read_variable_data(pf, current_var) == 0 && pf->data) {
+            /* The whole field is in memory: cache every layer at once */
+            field_layer_moments(pf->data, pf->grid_dims, axis, moments);
+        } else {
+            for (size_t i = 0; i < (size_t)n_layers * STATS_MOMENTS; i++) moments[i] = NAN;
         }
 
-        /* Skewness = E[(X - mu)^3] / sigma^3 */
-        if (stds[t] > 0) {
-            double std3 = stds[t] * stds[t] * stds[t];
-            skewness[t] = (sum_third / slice_size) / std3;
-        } else {
-            skewness[t] = 0.0;
+        const double *m = &moments[(size_t)slice_idx * STATS_MOMENTS];
+        if (!isnan(m[0])) {
+            means[t] = m[0];
+            stds[t] = m[1];
+            skewness[t] = m[2];
+            stats_cache_store(pf->plotfile_dir, level, var, axis, n_layers, moments);
+        }
+        free(moments);
+
+        /* Mapped pages cannot be dropped, so unmap before advising. The
+         * timestep on screen keeps its pages. */
+        release_mapped_files();
+        if (t != original_timestep) {
+            advised += advise_timestep_reads(timestep_paths[t], level, pf->ndim,
+                                             pf->n_vars, current_var, plane_axis, slice_idx,
+                                             POSIX_FADV_DONTNEED);
         }
 
-        if ((t + 1) % 10 == 0 || t == n_timesteps - 1) {
-            printf("  Processed %d/%d timesteps\n", t + 1, n_timesteps);
+        if ((n + 1) % 10 == 0 || n == n_missing - 1) {
+            printf("  Processed %d/%d timesteps\n", n + 1, n_missing);
         }
     }
+    sweep_mode = 0;
 
     /* Restore original state */
-    strncpy(pf->plotfile_dir, original_dir, MAX_PATH - 1);
-    current_timestep = original_timestep;
-    read_header(pf);
-    pf->n_boxes = 0;
-    read_cell_h(pf);
-    read_variable_data(pf, current_var);
+    if (n_missing > 0) {
+        printf("Sweep let the kernel drop %.1f MB of page cache\n", advised / (1024.0 * 1024.0));
+        strncpy(pf->plotfile_dir, original_dir, MAX_PATH - 1);
+        current_timestep = original_timestep;
+        read_header(pf);
+        pf->n_boxes = 0;
+        read_cell_h(pf);
+        load_variable(pf, current_var);
+    }
+    free(missing);
 
     /* Create plot data for mean */
     PlotData *mean_plot = (PlotData *)malloc(sizeof(PlotData));
@@ -6496,9 +11614,16 @@ void show_time_series(PlotfileData *pf) {
 }
 
 void cleanup(PlotfileData *pf) {
-    if (pf->data) free(pf->data);
+    field_cache_release(pf->data);
+    if (pf->plane) free(pf->plane);
+    free_resident_fields(pf);
+    free_all_levels(pf);
+    free_plotfile_metadata(pf);
+    release_mapped_files();
     if (pixel_data) free(pixel_data);
+    destroy_frame_image();
     if (current_slice_data) free(current_slice_data);
+    xtile_free();
 }
 
 /* ========== SDM Mode GUI and Rendering ========== */
@@ -6992,6 +12117,7 @@ void init_sdm_gui(ParticleData *pd, const char *plotfile_dir, int argc, char **a
     toplevel = XtAppInitialize(NULL, "PLTView-SDM", NULL, 0, &argc, argv, NULL, NULL, 0);
     display = XtDisplay(toplevel);
     screen = DefaultScreen(display);
+    set_pixel_format(DefaultVisual(display, screen));
 
     /* Load font */
     font = XLoadQueryFont(display, "fixed");
@@ -7137,29 +12263,136 @@ int main(int argc, char **argv) {
     char check_path[MAX_PATH];
     const char *prefix = "plt";  /* Default prefix */
 
-    /* Check for --sdm flag */
+    /* Check for --sdm, --slice-mode, --out-of-core MB, --float32, --cache-mb N,
+     * --prefetch N, --prefetch-mb N, --io <backend>, --io-threads N and
+     * --benchmark-io and --check-io flags, and --benchmark-colormap [side] */
+    int benchmark_io = 0;
+    int check_io = 0;
+    int benchmark_cmap = 0;
+    int build_slices = 0;
     for (int i = 1; i < argc; i++) {
+        int consumed = 0;
         if (strcmp(argv[i], "--sdm") == 0) {
             sdm_mode = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--slice-mode") == 0) {
+            slice_mode = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--float32") == 0) {
+            field_float32 = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--benchmark-io") == 0) {
+            benchmark_io = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--check-io") == 0) {
+            check_io = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--benchmark-colormap") == 0) {
+            benchmark_cmap = 4096;  /* 16.8 Mpixel */
+            consumed = 1;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                benchmark_cmap = atoi(argv[i + 1]);
+                if (benchmark_cmap < 1) benchmark_cmap = 1;
+                consumed = 2;
+            }
+        } else if (strcmp(argv[i], "--build-slice-cache") == 0) {
+            build_slices = 1;
+            consumed = 1;
+        } else if (strcmp(argv[i], "--out-of-core") == 0 && i + 1 < argc) {
+            ooc_mb = atoi(argv[i + 1]);
+            if (ooc_mb < 1) ooc_mb = 1;
+            slice_mode = 1;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--cache-mb") == 0 && i + 1 < argc) {
+            cache_mb = atoi(argv[i + 1]);
+            if (cache_mb < 0) cache_mb = 0;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+            prefetch_depth = atoi(argv[i + 1]);
+            if (prefetch_depth < 0) prefetch_depth = 0;
+            if (prefetch_depth > MAX_PREFETCH_SLOTS - 1) prefetch_depth = MAX_PREFETCH_SLOTS - 1;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--prefetch-mb") == 0 && i + 1 < argc) {
+            prefetch_mb = atoi(argv[i + 1]);
+            if (prefetch_mb < 0) prefetch_mb = 0;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--io-threads") == 0 && i + 1 < argc) {
+            io_threads = atoi(argv[i + 1]);
+            if (io_threads < 1) io_threads = 1;
+            if (io_threads > MAX_IO_THREADS) io_threads = MAX_IO_THREADS;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--io-depth") == 0 && i + 1 < argc) {
+            io_depth = atoi(argv[i + 1]);
+            if (io_depth < 1) io_depth = 1;
+            if (io_depth > MAX_IO_DEPTH) io_depth = MAX_IO_DEPTH;
+            consumed = 2;
+        } else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            if (strcmp(argv[i + 1], "mmap") == 0) {
+                io_backend = IO_BACKEND_MMAP;
+            } else if (strcmp(argv[i + 1], "stdio") == 0) {
+                io_backend = IO_BACKEND_STDIO;
+            } else if (strcmp(argv[i + 1], "uring") == 0) {
+                io_backend = IO_BACKEND_URING;
+            } else {
+                fprintf(stderr, "Error: Unknown I/O backend '%s' (use stdio, mmap or uring)\n", argv[i + 1]);
+                return 1;
+            }
+            consumed = 2;
+        }
+        if (consumed) {
             /* Shift remaining args over this flag */
-            for (int j = i; j < argc - 1; j++) {
-                argv[j] = argv[j + 1];
+            for (int j = i; j < argc - consumed; j++) {
+                argv[j] = argv[j + consumed];
             }
-            argc--;
+            argc -= consumed;
             i--;  /* Re-check this position */
         }
     }
 
+    /* Headless colormap benchmark: needs no plotfile and no X connection */
+    if (benchmark_cmap) {
+        return run_colormap_benchmark(benchmark_cmap) < 0 ? 1 : 0;
+    }
+
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s [--sdm] <plotfile_directory> [prefix]\n", argv[0]);
+        fprintf(stderr, "Usage: %s [--sdm] [--slice-mode] [--out-of-core MB] [--cache-mb N] [--prefetch N]\n"
+                        "          [--prefetch-mb N] [--io stdio|mmap|uring] [--io-threads N] [--io-depth N]"
+                        " [--float32]"
+                        " <plotfile_directory> [prefix]\n", argv[0]);
         fprintf(stderr, "  Single plotfile:    %s plt00100\n", argv[0]);
         fprintf(stderr, "  Multi-timestep:     %s /path/to/dir plt\n", argv[0]);
         fprintf(stderr, "  With prefix plt2d:  %s /path/to/dir plt2d\n", argv[0]);
         fprintf(stderr, "  SDM mode:           %s --sdm plt00100\n", argv[0]);
         fprintf(stderr, "  SDM multi-timestep: %s --sdm /path/to/dir plt\n", argv[0]);
+        fprintf(stderr, "  I/O benchmark:      %s --benchmark-io plt00100\n", argv[0]);
+        fprintf(stderr, "  Reader self-check:  %s --check-io plt00100 [variable]\n", argv[0]);
+        fprintf(stderr, "  Colormap benchmark: %s --benchmark-colormap [side]\n", argv[0]);
+        fprintf(stderr, "  Slice sidecar:      %s --build-slice-cache /path/to/dir theta z [plt]\n", argv[0]);
         return 1;
     }
 
+    /* Headless reader benchmark: no X connection needed */
+    if (benchmark_io) {
+        return run_io_benchmark(argv[1]) < 0 ? 1 : 0;
+    }
+
+    /* Headless reader self-check: <plotfile> [variable] */
+    if (check_io) {
+        return run_io_check(argv[1], argc >= 3 ? argv[2] : NULL) < 0 ? 1 : 0;
+    }
+
+    /* Headless sidecar build: <run_directory> <variable> x|y|z [prefix] */
+    if (build_slices) {
+        const char *axes = "xyz";
+        const char *a = (argc >= 4 && argv[3][0] && !argv[3][1]) ? strchr(axes, tolower(argv[3][0])) : NULL;
+        if (!a) {
+            fprintf(stderr, "Usage: %s --build-slice-cache <run_directory> <variable> x|y|z [prefix]\n",
+                    argv[0]);
+            return 1;
+        }
+        return build_slice_cache(argv[1], argc >= 5 ? argv[4] : prefix, argv[2], (int)(a - axes)) < 0 ? 1 : 0;
+    }
+
     /* Get prefix from argument if provided */
     if (argc >= 3) {
         prefix = argv[2];
@@ -7174,6 +12407,7 @@ int main(int argc, char **argv) {
         if (fp) {
             /* Single plotfile with SDM data */
             fclose(fp);
+            if (reserve_timesteps(1) < 0) return 1;
             n_timesteps = 1;
             current_timestep = 0;
             timestep_paths[0] = strdup(argv[1]);
@@ -7234,6 +12468,7 @@ int main(int argc, char **argv) {
         if (fp) {
             /* Single plotfile mode */
             fclose(fp);
+            if (reserve_timesteps(1) < 0) return 1;
             n_timesteps = 1;
             current_timestep = 0;
             timestep_paths[0] = strdup(argv[1]);
@@ -7389,7 +12624,7 @@ int main(int argc, char **argv) {
     pf.slice_idx = 0;  /* Start at first layer */
     pf.colormap = 0;  /* viridis */
 
-    read_variable_data(&pf, 0);
+    load_variable(&pf, 0);
 
     /* Initialize GUI */
     init_gui(&pf, argc, argv);
@@ -7398,6 +12633,7 @@ int main(int argc, char **argv) {
     update_time_label();
     update_info_label(&pf);
     render_slice(&pf);
+    schedule_prefetch(&pf);
 
     printf("\nGUI Controls:\n");
     printf("  Click variable buttons to change variable\n");
@@ -7414,22 +12650,21 @@ int main(int argc, char **argv) {
     
     /* Main event loop with expose and keyboard handling */
     XtAppContext app_context = XtWidgetToApplicationContext(toplevel);
+    if (timestep_scan.active) {
+        XtAppAddTimeOut(app_context, 100, scan_poll_timeout, (XtPointer)app_context);
+    }
     while (1) {
         XEvent event;
         XtAppNextEvent(app_context, &event);
         
         /* Handle expose events */
         if (event.type == Expose) {
-            if (event.xexpose.window == canvas && global_pf && global_pf->data) {
-                render_slice(global_pf);
+            expose_window(event.xexpose.window, event.xexpose.x, event.xexpose.y,
+                          event.xexpose.width, event.xexpose.height);
+            if (event.xexpose.window == canvas && global_pf && !initial_focus_set) {
                 /* Set keyboard focus on first expose - needed for remote X11 */
-                if (!initial_focus_set) {
-                    XSetInputFocus(display, canvas, RevertToParent, CurrentTime);
-                    initial_focus_set = 1;
-                }
-            } else if (event.xexpose.window == colorbar && global_pf) {
-                draw_colorbar(current_vmin, current_vmax, global_pf->colormap,
-                              global_pf->variables[global_pf->current_var]);
+                XSetInputFocus(display, canvas, RevertToParent, CurrentTime);
+                initial_focus_set = 1;
             }
         }
         /* Handle keyboard events */